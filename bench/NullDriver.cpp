@@ -0,0 +1,444 @@
+// Copyright (c) 2019,  Zhirnov Andrey. For more information see 'LICENSE'
+
+#include "bench/NullDriver.h"
+#include "src/LayerManager.h"
+#include "vulkan/vk_layer.h"
+
+namespace VSA
+{
+namespace
+{
+	//
+	// Dispatchable Object
+	//
+
+	struct DispatchableObject
+	{
+		const void*		dispatch	= null;		// loader dispatch table, used as a key by the layers
+	};
+
+	struct NullDevice : DispatchableObject
+	{
+		DispatchableObject		queues [NullDriver::QueueCount];
+	};
+
+	static DispatchableObject	s_physicalDevice;
+	static std::atomic<uint64_t>	s_handleCounter {0};
+	static std::atomic<uint>	s_imageCounter {0};
+
+	using FnTable_t = HashMap< StringView, PFN_vkVoidFunction >;
+
+/*
+=================================================
+	NewHandle
+=================================================
+*/
+	template <typename T>
+	ND_ inline T  NewHandle ()
+	{
+		const uint64_t	value = s_handleCounter.fetch_add( 1, std::memory_order_relaxed ) + 1;
+
+		if constexpr( std::is_pointer_v<T> )
+			return reinterpret_cast<T>( uintptr_t(value) );
+		else
+			return T(value);
+	}
+
+/*
+=================================================
+	NullFn
+----
+	default implementation for all functions without output handles
+=================================================
+*/
+	template <typename Fn>
+	struct NullFn;
+
+	template <typename R, typename ...Args>
+	struct NullFn< R (VKAPI_PTR *)(Args...) >
+	{
+		static VKAPI_ATTR R VKAPI_CALL  Call (Args...)
+		{
+			if constexpr( std::is_same_v< R, VkResult >)
+				return VK_SUCCESS;
+		}
+	};
+//-----------------------------------------------------------------------------
+	
+
+/*
+=================================================
+	instance functions
+=================================================
+*/
+	VKAPI_ATTR VkResult VKAPI_CALL  CreateInstance (const VkInstanceCreateInfo*, const VkAllocationCallbacks*, VkInstance* pInstance)
+	{
+		auto*	inst = new DispatchableObject{};
+		inst->dispatch = inst;
+
+		*pInstance = BitCast<VkInstance>( inst );
+		return VK_SUCCESS;
+	}
+
+	VKAPI_ATTR void VKAPI_CALL  DestroyInstance (VkInstance instance, const VkAllocationCallbacks*)
+	{
+		delete BitCast<DispatchableObject *>( instance );
+	}
+
+	VKAPI_ATTR VkResult VKAPI_CALL  EnumeratePhysicalDevices (VkInstance instance, uint32_t* pPhysicalDeviceCount, VkPhysicalDevice* pPhysicalDevices)
+	{
+		if ( pPhysicalDevices )
+		{
+			if ( *pPhysicalDeviceCount < 1 )
+				return VK_INCOMPLETE;
+
+			s_physicalDevice.dispatch = BitCast<DispatchableObject *>( instance )->dispatch;
+			pPhysicalDevices[0] = BitCast<VkPhysicalDevice>( &s_physicalDevice );
+		}
+		*pPhysicalDeviceCount = 1;
+		return VK_SUCCESS;
+	}
+
+	VKAPI_ATTR VkResult VKAPI_CALL  EnumerateDeviceExtensionProperties (VkPhysicalDevice, const char*, uint32_t* pPropertyCount, VkExtensionProperties*)
+	{
+		*pPropertyCount = 0;
+		return VK_SUCCESS;
+	}
+
+	VKAPI_ATTR void VKAPI_CALL  GetPhysicalDeviceQueueFamilyProperties (VkPhysicalDevice, uint32_t* pQueueFamilyPropertyCount, VkQueueFamilyProperties* pQueueFamilyProperties)
+	{
+		if ( pQueueFamilyProperties and *pQueueFamilyPropertyCount > 0 )
+		{
+			pQueueFamilyProperties[0]			 = {};
+			pQueueFamilyProperties[0].queueFlags = VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT;
+			pQueueFamilyProperties[0].queueCount = NullDriver::QueueCount;
+		}
+		*pQueueFamilyPropertyCount = 1;
+	}
+
+	VKAPI_ATTR VkResult VKAPI_CALL  CreateDevice (VkPhysicalDevice, const VkDeviceCreateInfo*, const VkAllocationCallbacks*, VkDevice* pDevice)
+	{
+		auto*	dev = new NullDevice{};
+		dev->dispatch = dev;
+
+		for (auto& q : dev->queues) {
+			q.dispatch = dev->dispatch;
+		}
+
+		*pDevice = BitCast<VkDevice>( static_cast<DispatchableObject *>(dev) );
+		return VK_SUCCESS;
+	}
+//-----------------------------------------------------------------------------
+
+
+/*
+=================================================
+	device functions
+=================================================
+*/
+	VKAPI_ATTR void VKAPI_CALL  DestroyDevice (VkDevice device, const VkAllocationCallbacks*)
+	{
+		delete static_cast<NullDevice *>( BitCast<DispatchableObject *>( device ));
+	}
+
+	VKAPI_ATTR void VKAPI_CALL  GetDeviceQueue (VkDevice device, uint32_t, uint32_t queueIndex, VkQueue* pQueue)
+	{
+		auto*	dev = static_cast<NullDevice *>( BitCast<DispatchableObject *>( device ));
+
+		*pQueue = BitCast<VkQueue>( &dev->queues[ queueIndex % NullDriver::QueueCount ]);
+	}
+
+	VKAPI_ATTR void VKAPI_CALL  GetDeviceQueue2 (VkDevice device, const VkDeviceQueueInfo2* pQueueInfo, VkQueue* pQueue)
+	{
+		GetDeviceQueue( device, pQueueInfo->queueFamilyIndex, pQueueInfo->queueIndex, OUT pQueue );
+	}
+
+	VKAPI_ATTR VkResult VKAPI_CALL  CreateFence (VkDevice, const VkFenceCreateInfo*, const VkAllocationCallbacks*, VkFence* pFence)
+	{
+		*pFence = NewHandle<VkFence>();
+		return VK_SUCCESS;
+	}
+
+	VKAPI_ATTR VkResult VKAPI_CALL  CreateSemaphore (VkDevice, const VkSemaphoreCreateInfo*, const VkAllocationCallbacks*, VkSemaphore* pSemaphore)
+	{
+		*pSemaphore = NewHandle<VkSemaphore>();
+		return VK_SUCCESS;
+	}
+
+	VKAPI_ATTR VkResult VKAPI_CALL  CreateEvent (VkDevice, const VkEventCreateInfo*, const VkAllocationCallbacks*, VkEvent* pEvent)
+	{
+		*pEvent = NewHandle<VkEvent>();
+		return VK_SUCCESS;
+	}
+
+	VKAPI_ATTR VkResult VKAPI_CALL  CreateCommandPool (VkDevice, const VkCommandPoolCreateInfo*, const VkAllocationCallbacks*, VkCommandPool* pCommandPool)
+	{
+		*pCommandPool = NewHandle<VkCommandPool>();
+		return VK_SUCCESS;
+	}
+
+	VKAPI_ATTR VkResult VKAPI_CALL  AllocateCommandBuffers (VkDevice device, const VkCommandBufferAllocateInfo* pAllocateInfo, VkCommandBuffer* pCommandBuffers)
+	{
+		for (uint i = 0; i < pAllocateInfo->commandBufferCount; ++i)
+		{
+			auto*	cmd = new DispatchableObject{};
+			cmd->dispatch = BitCast<DispatchableObject *>( device )->dispatch;
+
+			pCommandBuffers[i] = BitCast<VkCommandBuffer>( cmd );
+		}
+		return VK_SUCCESS;
+	}
+
+	VKAPI_ATTR void VKAPI_CALL  FreeCommandBuffers (VkDevice, VkCommandPool, uint32_t commandBufferCount, const VkCommandBuffer* pCommandBuffers)
+	{
+		for (uint i = 0; i < commandBufferCount; ++i) {
+			delete BitCast<DispatchableObject *>( pCommandBuffers[i] );
+		}
+	}
+
+	VKAPI_ATTR VkResult VKAPI_CALL  CreateSwapchainKHR (VkDevice, const VkSwapchainCreateInfoKHR*, const VkAllocationCallbacks*, VkSwapchainKHR* pSwapchain)
+	{
+		*pSwapchain = NewHandle<VkSwapchainKHR>();
+		return VK_SUCCESS;
+	}
+
+	VKAPI_ATTR VkResult VKAPI_CALL  AcquireNextImageKHR (VkDevice, VkSwapchainKHR, uint64_t, VkSemaphore, VkFence, uint32_t* pImageIndex)
+	{
+		*pImageIndex = s_imageCounter.fetch_add( 1, std::memory_order_relaxed ) % NullDriver::SwapchainImageCount;
+		return VK_SUCCESS;
+	}
+
+	VKAPI_ATTR VkResult VKAPI_CALL  AcquireNextImage2KHR (VkDevice device, const VkAcquireNextImageInfoKHR* pAcquireInfo, uint32_t* pImageIndex)
+	{
+		return AcquireNextImageKHR( device, pAcquireInfo->swapchain, pAcquireInfo->timeout, pAcquireInfo->semaphore, pAcquireInfo->fence, OUT pImageIndex );
+	}
+//-----------------------------------------------------------------------------
+	
+
+/*
+=================================================
+	GetDeviceTable
+=================================================
+*/
+	ND_ static FnTable_t const&  GetDeviceTable ()
+	{
+		static const FnTable_t	table = [] ()
+		{
+			FnTable_t	result;
+
+			#define VISITOR( _name_ )	result["vk" #_name_] = BitCast<PFN_vkVoidFunction>( &NullFn< PFN_vk ## _name_ >::Call );
+			DEVICE_FN_LIST( VISITOR )
+			#undef VISITOR
+			
+			#define VISITOR( _name_ )	result["vk" #_name_] = BitCast<PFN_vkVoidFunction>( &_name_ );
+			VISITOR( DestroyDevice )
+			VISITOR( GetDeviceQueue )
+			VISITOR( GetDeviceQueue2 )
+			VISITOR( CreateFence )
+			VISITOR( CreateSemaphore )
+			VISITOR( CreateEvent )
+			VISITOR( CreateCommandPool )
+			VISITOR( AllocateCommandBuffers )
+			VISITOR( FreeCommandBuffers )
+			VISITOR( CreateSwapchainKHR )
+			VISITOR( AcquireNextImageKHR )
+			VISITOR( AcquireNextImage2KHR )
+			#undef VISITOR
+
+			result["vkGetDeviceProcAddr"] = BitCast<PFN_vkVoidFunction>( &NullDriver::GetDeviceProcAddr );
+			return result;
+		}();
+		return table;
+	}
+
+/*
+=================================================
+	GetInstanceTable
+=================================================
+*/
+	ND_ static FnTable_t const&  GetInstanceTable ()
+	{
+		static const FnTable_t	table = [] ()
+		{
+			FnTable_t	result = GetDeviceTable();
+			
+			#define VISITOR( _name_ )	result["vk" #_name_] = BitCast<PFN_vkVoidFunction>( &_name_ );
+			VISITOR( CreateInstance )
+			VISITOR( DestroyInstance )
+			VISITOR( EnumeratePhysicalDevices )
+			VISITOR( EnumerateDeviceExtensionProperties )
+			VISITOR( GetPhysicalDeviceQueueFamilyProperties )
+			VISITOR( CreateDevice )
+			#undef VISITOR
+				
+			result["vkGetInstanceProcAddr"] = BitCast<PFN_vkVoidFunction>( &NullDriver::GetInstanceProcAddr );
+			return result;
+		}();
+		return table;
+	}
+
+/*
+=================================================
+	SetLoaderData
+----
+	the loader sets dispatch pointer of the object that is created by the layer
+=================================================
+*/
+	VKAPI_ATTR VkResult VKAPI_CALL  SetInstanceLoaderData (VkInstance instance, void* object)
+	{
+		static_cast<DispatchableObject *>(object)->dispatch = BitCast<DispatchableObject *>( instance )->dispatch;
+		return VK_SUCCESS;
+	}
+
+	VKAPI_ATTR VkResult VKAPI_CALL  SetDeviceLoaderData (VkDevice device, void* object)
+	{
+		static_cast<DispatchableObject *>(object)->dispatch = BitCast<DispatchableObject *>( device )->dispatch;
+		return VK_SUCCESS;
+	}
+
+}	// namespace
+//-----------------------------------------------------------------------------
+
+
+	
+/*
+=================================================
+	GetInstanceProcAddr
+=================================================
+*/
+	VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL  NullDriver::GetInstanceProcAddr (VkInstance, const char* pName)
+	{
+		auto&	table	= GetInstanceTable();
+		auto	iter	= table.find( pName );
+		return iter != table.end() ? iter->second : null;
+	}
+	
+/*
+=================================================
+	GetDeviceProcAddr
+=================================================
+*/
+	VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL  NullDriver::GetDeviceProcAddr (VkDevice, const char* pName)
+	{
+		auto&	table	= GetDeviceTable();
+		auto	iter	= table.find( pName );
+		return iter != table.end() ? iter->second : null;
+	}
+//-----------------------------------------------------------------------------
+
+	
+
+/*
+=================================================
+	Create
+----
+	the loader passes the next layer in 'VkLayerInstanceCreateInfo'
+	and 'VkLayerDeviceCreateInfo', the layer moves the link to the next element before calling down.
+=================================================
+*/
+	bool  LayerChain::Create (PFN_vkGetInstanceProcAddr layerGetInstanceProcAddr)
+	{
+		Destroy();
+
+		_getInstanceProcAddr = layerGetInstanceProcAddr;
+		CHECK_ERR( _getInstanceProcAddr );
+
+		// create instance
+		{
+			VkLayerInstanceLink		inst_link = {};
+			inst_link.pfnNextGetInstanceProcAddr = &NullDriver::GetInstanceProcAddr;
+
+			VkLayerInstanceCreateInfo	loader_data_ci = {};
+			loader_data_ci.sType	= VK_STRUCTURE_TYPE_LOADER_INSTANCE_CREATE_INFO;
+			loader_data_ci.function	= VK_LOADER_DATA_CALLBACK;
+			loader_data_ci.u.pfnSetInstanceLoaderData = &SetInstanceLoaderData;
+
+			VkLayerInstanceCreateInfo	link_ci = {};
+			link_ci.sType		= VK_STRUCTURE_TYPE_LOADER_INSTANCE_CREATE_INFO;
+			link_ci.pNext		= &loader_data_ci;
+			link_ci.function	= VK_LAYER_LINK_INFO;
+			link_ci.u.pLayerInfo = &inst_link;
+
+			VkApplicationInfo		app_info = {};
+			app_info.sType				= VK_STRUCTURE_TYPE_APPLICATION_INFO;
+			app_info.pApplicationName	= "null driver";
+			app_info.apiVersion			= VK_MAKE_VERSION( 1, 1, 0 );
+
+			VkInstanceCreateInfo	inst_ci = {};
+			inst_ci.sType				= VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+			inst_ci.pNext				= &link_ci;
+			inst_ci.pApplicationInfo	= &app_info;
+
+			auto	create_instance = InstanceFn<PFN_vkCreateInstance>( "vkCreateInstance" );
+			CHECK_ERR( create_instance );
+			CHECK_ERR( create_instance( &inst_ci, null, OUT &_instance ) == VK_SUCCESS );
+		}
+
+		// choose physical device
+		{
+			uint32_t	count = 1;
+			CHECK_ERR( InstanceFn<PFN_vkEnumeratePhysicalDevices>( "vkEnumeratePhysicalDevices" )( _instance, INOUT &count, OUT &_physicalDevice ) == VK_SUCCESS );
+			CHECK_ERR( _physicalDevice );
+		}
+
+		// create device
+		{
+			VkLayerDeviceLink		dev_link = {};
+			dev_link.pfnNextGetInstanceProcAddr	= &NullDriver::GetInstanceProcAddr;
+			dev_link.pfnNextGetDeviceProcAddr	= &NullDriver::GetDeviceProcAddr;
+			
+			VkLayerDeviceCreateInfo	loader_data_ci = {};
+			loader_data_ci.sType	= VK_STRUCTURE_TYPE_LOADER_DEVICE_CREATE_INFO;
+			loader_data_ci.function	= VK_LOADER_DATA_CALLBACK;
+			loader_data_ci.u.pfnSetDeviceLoaderData = &SetDeviceLoaderData;
+
+			VkLayerDeviceCreateInfo	link_ci = {};
+			link_ci.sType		= VK_STRUCTURE_TYPE_LOADER_DEVICE_CREATE_INFO;
+			link_ci.pNext		= &loader_data_ci;
+			link_ci.function	= VK_LAYER_LINK_INFO;
+			link_ci.u.pLayerInfo = &dev_link;
+
+			const float		priorities[NullDriver::QueueCount] = {};
+
+			VkDeviceQueueCreateInfo	queue_ci = {};
+			queue_ci.sType				= VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+			queue_ci.queueFamilyIndex	= 0;
+			queue_ci.queueCount			= NullDriver::QueueCount;
+			queue_ci.pQueuePriorities	= priorities;
+
+			VkDeviceCreateInfo		dev_ci = {};
+			dev_ci.sType				= VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+			dev_ci.pNext				= &link_ci;
+			dev_ci.queueCreateInfoCount	= 1;
+			dev_ci.pQueueCreateInfos	= &queue_ci;
+
+			auto	create_device = InstanceFn<PFN_vkCreateDevice>( "vkCreateDevice" );
+			CHECK_ERR( create_device );
+			CHECK_ERR( create_device( _physicalDevice, &dev_ci, null, OUT &_device ) == VK_SUCCESS );
+		}
+
+		_getDeviceProcAddr = InstanceFn<PFN_vkGetDeviceProcAddr>( "vkGetDeviceProcAddr" );
+		CHECK_ERR( _getDeviceProcAddr );
+		return true;
+	}
+	
+/*
+=================================================
+	Destroy
+=================================================
+*/
+	void  LayerChain::Destroy ()
+	{
+		if ( _device )
+			DeviceFn<PFN_vkDestroyDevice>( "vkDestroyDevice" )( _device, null );
+
+		if ( _instance )
+			InstanceFn<PFN_vkDestroyInstance>( "vkDestroyInstance" )( _instance, null );
+
+		_instance			= VK_NULL_HANDLE;
+		_physicalDevice		= VK_NULL_HANDLE;
+		_device				= VK_NULL_HANDLE;
+		_getDeviceProcAddr	= null;
+	}
+
+}	// VSA
@@ -0,0 +1,73 @@
+// Copyright (c) 2019,  Zhirnov Andrey. For more information see 'LICENSE'
+
+#pragma once
+
+#include "vulkan/vulkan.h"
+#include "stl/Common.h"
+#include "stl/Algorithms/Cast.h"
+
+namespace VSA
+{
+
+	//
+	// Null Driver
+	//
+	// Stands in for the next layer in the chain: functions do nothing,
+	// return success and create fake handles.
+	// Dispatchable handles start with a dispatch pointer like the handles created by the loader,
+	// queues and command buffers share the dispatch pointer of their device.
+	//
+
+	struct NullDriver
+	{
+		static VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL  GetInstanceProcAddr (VkInstance instance, const char* pName);
+		static VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL  GetDeviceProcAddr (VkDevice device, const char* pName);
+
+		static constexpr uint	QueueCount			= 4;
+		static constexpr uint	SwapchainImageCount	= 3;
+	};
+
+
+
+	//
+	// Layer Chain
+	//
+	// Creates instance and device through the layer entry points
+	// with the null driver as the next layer, in the same way as the loader does.
+	//
+
+	class LayerChain
+	{
+	// variables
+	private:
+		PFN_vkGetInstanceProcAddr	_getInstanceProcAddr	= null;		// entry points of the tested layer
+		PFN_vkGetDeviceProcAddr		_getDeviceProcAddr		= null;
+		VkInstance					_instance				= VK_NULL_HANDLE;
+		VkPhysicalDevice			_physicalDevice			= VK_NULL_HANDLE;
+		VkDevice					_device					= VK_NULL_HANDLE;
+
+
+	// methods
+	public:
+		LayerChain () {}
+		~LayerChain ()	{ Destroy(); }
+
+		LayerChain (const LayerChain &) = delete;
+		LayerChain&  operator = (const LayerChain &) = delete;
+
+		bool  Create (PFN_vkGetInstanceProcAddr layerGetInstanceProcAddr);
+		void  Destroy ();
+
+		template <typename Fn>
+		ND_ Fn  InstanceFn (const char* name) const		{ return BitCast<Fn>( _getInstanceProcAddr( _instance, name )); }
+
+		template <typename Fn>
+		ND_ Fn  DeviceFn (const char* name) const		{ return BitCast<Fn>( _getDeviceProcAddr( _device, name )); }
+
+		ND_ VkInstance			Instance ()			const	{ return _instance; }
+		ND_ VkPhysicalDevice	PhysicalDevice ()	const	{ return _physicalDevice; }
+		ND_ VkDevice			Device ()			const	{ return _device; }
+	};
+
+
+}	// VSA
@@ -0,0 +1,404 @@
+// Copyright (c) 2019,  Zhirnov Andrey. For more information see 'LICENSE'
+/*
+	Measures cost of each intercepted device function, the null driver is used as the next layer.
+
+	usage: VSA-Bench [--capture] [--iterations N]
+
+	--capture		capture is active during the test (flight recorder mode),
+					settings are read once per process, so the idle and active results
+					are produced by separate runs.
+	--iterations	number of calls per thread for each function.
+
+	Result is 'ns/call' for 1, 2, 4, 8 and 16 threads that call the same function concurrently,
+	'driver' column is the cost of the null driver without the layer,
+	functions marked with '*' are the most frequently used.
+*/
+
+#include "bench/NullDriver.h"
+#include "src/LayerManager.h"
+#include "stl/Platforms/PerformanceCounter.h"
+#include "stl/Containers/ArrayView.h"
+#include "stl/Math/Math.h"
+#include "stl/Algorithms/StringUtils.h"
+
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <thread>
+
+using namespace VSA;
+
+namespace
+{
+	//
+	// Thread Context
+	//
+
+	struct ThreadContext
+	{
+		VkDevice			device		= VK_NULL_HANDLE;
+		VkQueue				queue		= VK_NULL_HANDLE;
+		VkCommandPool		cmdPool		= VK_NULL_HANDLE;
+		VkCommandBuffer		cmdBuffer	= VK_NULL_HANDLE;
+		VkFence				fence		= VK_NULL_HANDLE;
+		VkSemaphore			semaphores [2]	= {};
+		VkEvent				event		= VK_NULL_HANDLE;
+		VkSwapchainKHR		swapchain	= VK_NULL_HANDLE;
+	};
+
+	using RunFn_t = void (*) (PFN_vkVoidFunction fn, const ThreadContext &ctx, uint iterations);
+
+	struct BenchCase
+	{
+		StringView		name;
+		RunFn_t			run		= null;
+		bool			hot		= false;	// frequently called by applications
+		bool			destroy	= false;	// called with null handles, so resources stay valid for other tests
+	};
+
+	static constexpr uint	ThreadCounts[]	= { 1, 2, 4, 8, 16 };
+	static constexpr uint	MaxThreads		= 16;
+
+	// handles must be different types to select argument by type
+	STATIC_ASSERT( sizeof(void*) == sizeof(uint64_t), "64 bit platform is required" );
+
+	
+/*
+=================================================
+	ArgOf
+----
+	argument for generic call: handles from the thread context,
+	pointers to zeroed structures and zero for other values
+=================================================
+*/
+	template <typename T>
+	struct ArgOf {
+		ND_ static T  Get (const ThreadContext &)		{ return T{}; }
+	};
+
+	template <typename T>
+	struct ArgOf< const T* > {
+		ND_ static const T*  Get (const ThreadContext &)	{ static const T value = {};  return &value; }
+	};
+
+	template <typename T>
+	struct ArgOf< T* > {
+		ND_ static T*  Get (const ThreadContext &)		{ thread_local T value = {};  return &value; }
+	};
+
+	#define ARG_OF( _type_, _field_ ) \
+		template <> \
+		struct ArgOf< _type_ > { \
+			ND_ static _type_  Get (const ThreadContext &ctx)	{ return ctx._field_; } \
+		}
+	
+	ARG_OF( VkDevice,			device );
+	ARG_OF( VkQueue,			queue );
+	ARG_OF( VkCommandPool,		cmdPool );
+	ARG_OF( VkCommandBuffer,	cmdBuffer );
+	ARG_OF( VkFence,			fence );
+	ARG_OF( VkSemaphore,		semaphores[0] );
+	ARG_OF( VkEvent,			event );
+	ARG_OF( VkSwapchainKHR,		swapchain );
+	#undef ARG_OF
+
+/*
+=================================================
+	RunGeneric
+=================================================
+*/
+	template <typename Fn>
+	struct GenericCall;
+
+	template <typename R, typename ...Args>
+	struct GenericCall< R (VKAPI_PTR *)(Args...) >
+	{
+		using Fn = R (VKAPI_PTR *)(Args...);
+
+		static void  Run (PFN_vkVoidFunction fn, const ThreadContext &ctx, uint iterations)
+		{
+			const Fn	func = BitCast<Fn>( fn );
+			const auto	args = std::make_tuple( ArgOf<Args>::Get( ctx )... );
+
+			for (uint i = 0; i < iterations; ++i) {
+				std::apply( func, args );
+			}
+		}
+	};
+
+/*
+=================================================
+	RunQueueSubmit
+=================================================
+*/
+	static void  RunQueueSubmit (PFN_vkVoidFunction fn, const ThreadContext &ctx, uint iterations)
+	{
+		const auto					func	= BitCast<PFN_vkQueueSubmit>( fn );
+		const VkPipelineStageFlags	stage	= 0;
+
+		VkSubmitInfo	submit = {};
+		submit.sType				= VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submit.waitSemaphoreCount	= 1;
+		submit.pWaitSemaphores		= &ctx.semaphores[0];
+		submit.pWaitDstStageMask	= &stage;
+		submit.commandBufferCount	= 1;
+		submit.pCommandBuffers		= &ctx.cmdBuffer;
+		submit.signalSemaphoreCount	= 1;
+		submit.pSignalSemaphores	= &ctx.semaphores[1];
+
+		for (uint i = 0; i < iterations; ++i) {
+			func( ctx.queue, 1, &submit, ctx.fence );
+		}
+	}
+
+/*
+=================================================
+	RunWaitForFences / RunResetFences
+=================================================
+*/
+	static void  RunWaitForFences (PFN_vkVoidFunction fn, const ThreadContext &ctx, uint iterations)
+	{
+		const auto	func = BitCast<PFN_vkWaitForFences>( fn );
+
+		for (uint i = 0; i < iterations; ++i) {
+			func( ctx.device, 1, &ctx.fence, true, UMax );
+		}
+	}
+
+	static void  RunResetFences (PFN_vkVoidFunction fn, const ThreadContext &ctx, uint iterations)
+	{
+		const auto	func = BitCast<PFN_vkResetFences>( fn );
+
+		for (uint i = 0; i < iterations; ++i) {
+			func( ctx.device, 1, &ctx.fence );
+		}
+	}
+
+/*
+=================================================
+	RunQueuePresent
+=================================================
+*/
+	static void  RunQueuePresent (PFN_vkVoidFunction fn, const ThreadContext &ctx, uint iterations)
+	{
+		const auto		func		= BitCast<PFN_vkQueuePresentKHR>( fn );
+		const uint32_t	image_index	= 0;
+
+		VkPresentInfoKHR	present = {};
+		present.sType				= VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+		present.waitSemaphoreCount	= 1;
+		present.pWaitSemaphores		= &ctx.semaphores[1];
+		present.swapchainCount		= 1;
+		present.pSwapchains			= &ctx.swapchain;
+		present.pImageIndices		= &image_index;
+
+		for (uint i = 0; i < iterations; ++i) {
+			func( ctx.queue, &present );
+		}
+	}
+
+/*
+=================================================
+	GetBenchCases
+----
+	all functions from 'DEVICE_FN_LIST' except 'vkDestroyDevice',
+	functions that are recorded by the analyzer are called with realistic arguments.
+=================================================
+*/
+	ND_ static Array<BenchCase>  GetBenchCases ()
+	{
+		Array<BenchCase>	result;
+
+		#define VISITOR( _name_ )	result.push_back({ "vk" #_name_, &GenericCall< PFN_vk ## _name_ >::Run });
+		DEVICE_FN_LIST( VISITOR )
+		#undef VISITOR
+
+		const auto	Override = [&result] (StringView name, RunFn_t fn)
+		{
+			for (auto& item : result) {
+				if ( item.name == name )
+					item.run = fn;
+			}
+		};
+		Override( "vkQueueSubmit",		&RunQueueSubmit );
+		Override( "vkWaitForFences",	&RunWaitForFences );
+		Override( "vkResetFences",		&RunResetFences );
+		Override( "vkQueuePresentKHR",	&RunQueuePresent );
+
+		for (auto& item : result)
+		{
+			item.hot	 = (item.name == "vkQueueSubmit" or item.name == "vkWaitForFences" or item.name == "vkGetFenceStatus" or
+							item.name == "vkCmdPipelineBarrier" or item.name == "vkCmdBeginRenderPass");
+			item.destroy = (StartsWith( item.name, "vkDestroy" ) or StartsWith( item.name, "vkFree" ));
+		}
+
+		result.erase( std::remove_if( result.begin(), result.end(), [] (auto& item) { return item.name == "vkDestroyDevice"; }),
+					  result.end() );
+		return result;
+	}
+
+/*
+=================================================
+	Measure
+----
+	returns average time of a single call in nanoseconds
+=================================================
+*/
+	ND_ static double  Measure (const BenchCase &bc, PFN_vkVoidFunction fn, ArrayView<ThreadContext> contexts, uint iterations)
+	{
+		const uint				thread_count	= uint(contexts.size());
+		std::atomic<uint>		ready			{0};
+		std::atomic<uint64_t>	total_time		{0};
+		Array<std::thread>		threads;
+
+		for (uint t = 0; t < thread_count; ++t)
+		{
+			threads.emplace_back( [&, t] ()
+			{
+				// warm up
+				bc.run( fn, contexts[t], Max( iterations / 16, 1u ));
+
+				// start all threads at the same time
+				ready.fetch_add( 1, std::memory_order_acq_rel );
+				while ( ready.load( std::memory_order_acquire ) < thread_count ) {}
+
+				const uint64_t	start = PerformanceCounter::Now();
+				bc.run( fn, contexts[t], iterations );
+				total_time.fetch_add( PerformanceCounter::Now() - start, std::memory_order_relaxed );
+			});
+		}
+
+		for (auto& t : threads) {
+			t.join();
+		}
+		return double(total_time.load()) / (double(thread_count) * iterations);
+	}
+
+/*
+=================================================
+	SetEnv
+=================================================
+*/
+	static void  SetEnv (const char* name, const char* value)
+	{
+#	ifdef PLATFORM_WINDOWS
+		::_putenv_s( name, value );
+#	else
+		::setenv( name, value, 1 );
+#	endif
+	}
+
+}	// namespace
+
+/*
+=================================================
+	main
+=================================================
+*/
+int main (int argc, char** argv)
+{
+	bool	capture		= false;
+	uint	iterations	= 20'000;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const StringView	arg = argv[i];
+
+		if ( arg == "--capture" )
+			capture = true;
+		else
+		if ( arg == "--iterations" and i+1 < argc )
+			iterations = Max( uint(std::strtoul( argv[++i], null, 10 )), 1u );
+		else
+		{
+			std::cerr << "usage: VSA-Bench [--capture] [--iterations N]" << std::endl;
+			return 1;
+		}
+	}
+
+	// must be set before the layer reads settings,
+	// flight recorder keeps the capture active without the hotkey
+	if ( capture )
+		SetEnv( "VSA_FLIGHT_RECORDER_FRAMES", "8" );
+
+	LayerChain	chain;
+	CHECK_ERR( chain.Create( &LayerManager::vki_GetInstanceProcAddr ), 1 );
+
+	const VkDevice	dev = chain.Device();
+
+	// create per-thread resources
+	ThreadContext	contexts [MaxThreads];
+	{
+		auto	get_device_queue	= chain.DeviceFn<PFN_vkGetDeviceQueue>( "vkGetDeviceQueue" );
+		auto	create_fence		= chain.DeviceFn<PFN_vkCreateFence>( "vkCreateFence" );
+		auto	create_semaphore	= chain.DeviceFn<PFN_vkCreateSemaphore>( "vkCreateSemaphore" );
+		auto	create_event		= chain.DeviceFn<PFN_vkCreateEvent>( "vkCreateEvent" );
+		auto	create_cmd_pool		= chain.DeviceFn<PFN_vkCreateCommandPool>( "vkCreateCommandPool" );
+		auto	alloc_cmd_buffers	= chain.DeviceFn<PFN_vkAllocateCommandBuffers>( "vkAllocateCommandBuffers" );
+		auto	create_swapchain	= chain.DeviceFn<PFN_vkCreateSwapchainKHR>( "vkCreateSwapchainKHR" );
+
+		const VkFenceCreateInfo			fence_ci	= { VK_STRUCTURE_TYPE_FENCE_CREATE_INFO, null, 0 };
+		const VkSemaphoreCreateInfo		sem_ci		= { VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO, null, 0 };
+		const VkEventCreateInfo			event_ci	= { VK_STRUCTURE_TYPE_EVENT_CREATE_INFO, null, 0 };
+		const VkCommandPoolCreateInfo	pool_ci		= { VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO, null, 0, 0 };
+		const VkSwapchainCreateInfoKHR	swap_ci		= {};
+
+		for (uint t = 0; t < MaxThreads; ++t)
+		{
+			auto&	ctx = contexts[t];
+			ctx.device = dev;
+
+			get_device_queue( dev, 0, t % NullDriver::QueueCount, OUT &ctx.queue );
+			CHECK_ERR( create_fence( dev, &fence_ci, null, OUT &ctx.fence ) == VK_SUCCESS, 1 );
+			CHECK_ERR( create_semaphore( dev, &sem_ci, null, OUT &ctx.semaphores[0] ) == VK_SUCCESS, 1 );
+			CHECK_ERR( create_semaphore( dev, &sem_ci, null, OUT &ctx.semaphores[1] ) == VK_SUCCESS, 1 );
+			CHECK_ERR( create_event( dev, &event_ci, null, OUT &ctx.event ) == VK_SUCCESS, 1 );
+			CHECK_ERR( create_cmd_pool( dev, &pool_ci, null, OUT &ctx.cmdPool ) == VK_SUCCESS, 1 );
+			CHECK_ERR( create_swapchain( dev, &swap_ci, null, OUT &ctx.swapchain ) == VK_SUCCESS, 1 );
+
+			const VkCommandBufferAllocateInfo	alloc_info = { VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO, null, ctx.cmdPool, VK_COMMAND_BUFFER_LEVEL_PRIMARY, 1 };
+			CHECK_ERR( alloc_cmd_buffers( dev, &alloc_info, OUT &ctx.cmdBuffer ) == VK_SUCCESS, 1 );
+		}
+	}
+
+	// same device and queues, but without objects, destroy functions accept null handles
+	ThreadContext	null_contexts [MaxThreads];
+	for (uint t = 0; t < MaxThreads; ++t)
+	{
+		null_contexts[t].device	= contexts[t].device;
+		null_contexts[t].queue	= contexts[t].queue;
+	}
+
+	// present ends the frame, so events recorded by the previous test are released
+	auto	end_frame = [&chain, &contexts, present = chain.DeviceFn<PFN_vkQueuePresentKHR>( "vkQueuePresentKHR" )] ()
+	{
+		RunQueuePresent( BitCast<PFN_vkVoidFunction>( present ), contexts[0], 1 );
+	};
+
+	std::cout << "capture: " << (capture ? "active" : "idle") << ", iterations: " << iterations << ", ns/call\n"
+			  << "  " << std::left << std::setw(34) << "function" << std::right << std::setw(10) << "driver";
+	for (uint tc : ThreadCounts) {
+		std::cout << std::setw(9) << tc << 't';
+	}
+	std::cout << std::endl << std::fixed << std::setprecision(1);
+
+	for (auto& bc : GetBenchCases())
+	{
+		const String				name		{ bc.name };
+		const PFN_vkVoidFunction	layer_fn	= chain.DeviceFn<PFN_vkVoidFunction>( name.c_str() );
+		const PFN_vkVoidFunction	driver_fn	= NullDriver::GetDeviceProcAddr( dev, name.c_str() );
+		const ThreadContext*		ctx			= bc.destroy ? null_contexts : contexts;
+		CHECK_ERR( layer_fn and driver_fn, 1 );
+
+		std::cout << (bc.hot ? "* " : "  ") << std::left << std::setw(34) << name << std::right << std::setw(10)
+				  << Measure( bc, driver_fn, ArrayView<ThreadContext>{ ctx, 1 }, iterations );
+
+		for (uint tc : ThreadCounts)
+		{
+			std::cout << std::setw(10) << Measure( bc, layer_fn, ArrayView<ThreadContext>{ ctx, tc }, iterations );
+			end_frame();
+		}
+		std::cout << std::endl;
+	}
+	return 0;
+}
@@ -34,7 +34,7 @@ if (${VSA_ENABLE_GRAPHVIZ})
 	endif ()
 
 	if (UNIX)
-	# TODO
+		find_program( VSA_GRAPHVIZ_DOT_EXECUTABLE NAMES "dot" PATHS ${VSA_GRAPHVIZ_ROOT} PATH_SUFFIXES "bin" )
 	endif ()
 
 	add_library( "GraphViz-lib" INTERFACE )
@@ -0,0 +1,34 @@
+// Copyright (c) 2019,  Zhirnov Andrey. For more information see 'LICENSE'
+/*
+	Application interface of the VK_LAYER_AZ_sync_analyzer layer.
+
+	Functions are returned by 'vkGetDeviceProcAddr' when the layer is enabled,
+	null is returned otherwise, so the application can use them unconditionally:
+
+		auto begin_capture = (PFN_vkSyncAnalyzerBeginCaptureVSA) vkGetDeviceProcAddr( device, "vkSyncAnalyzerBeginCaptureVSA" );
+		if ( begin_capture )
+			begin_capture( device, 0 );
+*/
+
+#pragma once
+
+#include "vulkan/vulkan.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Starts capture of 'frameCount' frames, if zero capture continues until 'vkSyncAnalyzerEndCaptureVSA'.
+// Returns VK_NOT_READY if capture is already started or flight recorder is used.
+typedef VkResult (VKAPI_PTR *PFN_vkSyncAnalyzerBeginCaptureVSA) (VkDevice device, uint32_t frameCount);
+
+// Stops capture and exports captured frames, in flight recorder mode exports the last frames.
+// Returns VK_NOT_READY if capture is not started.
+typedef VkResult (VKAPI_PTR *PFN_vkSyncAnalyzerEndCaptureVSA) (VkDevice device);
+
+// Ends the frame, same as 'vkQueuePresentKHR'.
+typedef void (VKAPI_PTR *PFN_vkSyncAnalyzerMarkFrameVSA) (VkDevice device);
+
+#ifdef __cplusplus
+}
+#endif
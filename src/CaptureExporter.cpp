@@ -0,0 +1,291 @@
+// Copyright (c) 2019,  Zhirnov Andrey. For more information see 'LICENSE'
+
+#include "src/CaptureExporter.h"
+#include "src/SyncGraph.h"
+#include "src/LayerSettings.h"
+#include "stl/Platforms/PerformanceCounter.h"
+#include "stl/Algorithms/StringUtils.h"
+#include "stl/Stream/FileStream.h"
+
+#include <filesystem>
+
+namespace VSA
+{
+
+/*
+=================================================
+	constructor
+=================================================
+*/
+	CaptureExporter::CaptureExporter ()
+	{
+		_captureArena.SetBlockSize( LayerSettings::Get().captureArenaBlockSize );
+	}
+
+/*
+=================================================
+	destructor
+----
+	waits until all captures are exported
+=================================================
+*/
+	CaptureExporter::~CaptureExporter ()
+	{
+		{
+			EXLOCK( _queueGuard );
+			_looping = false;
+		}
+		_wakeCV.notify_one();
+
+		if ( _thread.joinable() )
+			_thread.join();
+	}
+
+/*
+=================================================
+	AcquireStorage
+=================================================
+*/
+	UniquePtr<EventStorage>  CaptureExporter::AcquireStorage ()
+	{
+		{
+			EXLOCK( _poolGuard );
+			if ( _pool.size() )
+			{
+				auto	storage = std::move( _pool.back() );
+				_pool.pop_back();
+				return storage;
+			}
+		}
+
+		UniquePtr<EventStorage>	storage{ new EventStorage{} };
+		storage->arena.SetBlockSize( LayerSettings::Get().threadArenaBlockSize );
+		return storage;
+	}
+
+/*
+=================================================
+	_ReleaseStorage
+=================================================
+*/
+	void  CaptureExporter::_ReleaseStorage (UniquePtr<EventStorage> &&storage)
+	{
+		storage->events.Clear();
+		storage->arena.Discard();
+
+		EXLOCK( _poolGuard );
+		_pool.push_back( std::move(storage) );
+	}
+
+/*
+=================================================
+	Export
+=================================================
+*/
+	void  CaptureExporter::Export (Capture &&capture)
+	{
+		{
+			EXLOCK( _queueGuard );
+			_queue.push_back( std::move(capture) );
+
+			if ( not _thread.joinable() )
+			{
+				_looping	= true;
+				_thread		= std::thread{ [this] () { _ExportLoop(); }};
+			}
+		}
+		_wakeCV.notify_one();
+	}
+
+/*
+=================================================
+	_ExportLoop
+----
+	pending captures are exported before exit
+=================================================
+*/
+	void  CaptureExporter::_ExportLoop ()
+	{
+		for (;;)
+		{
+			Capture		capture;
+			{
+				std::unique_lock	lock{ _queueGuard };
+				_wakeCV.wait( lock, [this] () { return _queue.size() or not _looping; });
+
+				if ( _queue.empty() )
+					return;
+
+				capture = std::move( _queue.front() );
+				_queue.pop_front();
+			}
+
+			_Export( capture );
+
+			for (auto& storage : capture.buffers) {
+				_ReleaseStorage( std::move(storage) );
+			}
+		}
+	}
+
+/*
+=================================================
+	_Export
+----
+	each capture is saved into a separate file,
+	so rendering of previous capture is not affected.
+=================================================
+*/
+	void  CaptureExporter::_Export (Capture &capture)
+	{
+		namespace FS = std::filesystem;
+
+		const uint64_t	start	= PerformanceCounter::Now();
+		FS::path		path	{ LayerSettings::Get().graphFile };
+
+		path.replace_filename( path.stem().concat( "_"s << ToString( _captureIndex.fetch_add( 1, std::memory_order_relaxed )))).replace_extension( ".dot" );
+
+		_Merge( capture );
+		VSA_LOGI( String(VSA_LAYER_NAME) << ": exporting capture, " << ToString( _capture.events.size() ) << " events" );
+
+		SyncGraph::SortEvents( INOUT _capture );
+		SyncGraph::ResolveDependencies( INOUT _capture, _captureArena );
+
+		const bool	saved = _SaveDotFile_v1( path.string() );
+		//_SaveDotFile_v2();
+		_LogMemoryUsage( capture );
+
+		_capture.Clear();
+		_captureArena.Discard();
+
+		VSA_LOGI( String(VSA_LAYER_NAME) << ": capture export " << (saved ? "completed" : "failed") << " in "
+					<< ToString( std::chrono::nanoseconds{ int64_t(PerformanceCounter::Now() - start) }));
+
+		if ( saved )
+			_Visualize( path.string() );
+	}
+
+/*
+=================================================
+	_Merge
+----
+	events are copied in order of buffers,
+	first name of thread or queue is used.
+=================================================
+*/
+	void  CaptureExporter::_Merge (const Capture &capture)
+	{
+		for (auto& storage : capture.buffers)
+		{
+			auto&	src = storage->events;
+
+			_capture.Append( src );
+
+			for (auto& item : src.queueNames)
+			{
+				if ( _capture.FindQueueName( item.object ).empty() )
+					_capture.SetQueueName( item.object, src.GetString( item.name ));
+			}
+			for (auto& item : src.threadNames)
+			{
+				const ThreadID	tid { uint(item.object) };
+
+				if ( _capture.FindThreadName( tid ).empty() )
+					_capture.SetThreadName( tid, src.GetString( item.name ));
+			}
+		}
+	}
+
+/*
+=================================================
+	_LogMemoryUsage
+=================================================
+*/
+	void  CaptureExporter::_LogMemoryUsage (const Capture &capture) const
+	{
+		BytesU	used, capacity;
+		for (auto& storage : capture.buffers)
+		{
+			used		+= storage->arena.UsedSize();
+			capacity	+= storage->arena.Capacity();
+		}
+
+		VSA_LOGI( String(VSA_LAYER_NAME) << ": capture arena: used " << ToString( _captureArena.UsedSize() )
+					<< ", high-water " << ToString( _captureArena.HighWaterMark() ) << ", capacity " << ToString( _captureArena.Capacity() )
+					<< "; " << ToString( capture.buffers.size() ) << " captured buffers: used " << ToString( used )
+					<< ", capacity " << ToString( capacity ));
+	}
+//-----------------------------------------------------------------------------
+
+
+/*
+=================================================
+	_SaveDotFile_v1
+=================================================
+*/
+	bool  CaptureExporter::_SaveDotFile_v1 (StringView path) const
+	{
+		namespace FS = std::filesystem;
+
+		if ( auto dir = FS::path{ path }.parent_path(); not dir.empty() )
+			FS::create_directories( dir );
+
+		FileWStream		wfile{ path };
+		CHECK_ERR( wfile.IsOpen() );
+		CHECK_ERR( SyncGraph::WriteDot_v1( _capture, wfile ));
+
+		VSA_LOGI( String(VSA_LAYER_NAME) << ": Dot-file saved into '"s << path << "'" );
+		return true;
+	}
+
+/*
+=================================================
+	_Visualize
+----
+	starts graphviz process for each format,
+	result is written into the log when process is finished.
+=================================================
+*/
+	void  CaptureExporter::_Visualize (StringView path)
+	{
+	#ifdef VSA_GRAPHVIZ_DOT_EXECUTABLE
+		StringView	formats = LayerSettings::Get().graphFormats;
+
+		for (size_t pos = 0; pos < formats.size();)
+		{
+			const size_t	end		= Min( formats.find( ',', pos ), formats.size() );
+			const String	format	{ formats.substr( pos, end - pos )};
+			pos = end + 1;
+
+			if ( format.empty() )
+				continue;
+
+			ProcessPool::Args_t	args;
+			args.push_back( VSA_GRAPHVIZ_DOT_EXECUTABLE );
+			args.push_back( "-T"s << format );
+			args.push_back( "-O" );
+			args.push_back( String{path} );
+
+			const uint64_t	start		= PerformanceCounter::Now();
+			const String	graph_path	= String{path} << '.' << format;
+
+			_renderer.Run( std::move(args), std::chrono::milliseconds{_renderTimeoutMS},
+						   [start, graph_path] (const ProcessPool::Args_t &, const ProcessPool::Result &res)
+						   {
+								if ( res.IsSucceeded() )
+								{
+									VSA_LOGI( String(VSA_LAYER_NAME) << ": Graph saved into '" << graph_path << "' in "
+												<< ToString( std::chrono::nanoseconds{ int64_t(PerformanceCounter::Now() - start) }));
+									return;
+								}
+								VSA_LOGI( String(VSA_LAYER_NAME) << ": failed to render graph '" << graph_path << "', "
+											<< (res.error.size() ? res.error : "graphviz exit code "s << ToString( res.exitCode )));
+						   });
+		}
+	#else
+		VSA_UNUSED( path );
+	#endif
+	}
+
+
+}	// VSA
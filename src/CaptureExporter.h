@@ -0,0 +1,104 @@
+// Copyright (c) 2019,  Zhirnov Andrey. For more information see 'LICENSE'
+
+#pragma once
+
+#include "src/SyncEvents.h"
+#include "stl/Containers/Ptr.h"
+#include "stl/Platforms/ProcessPool.h"
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+
+namespace VSA
+{
+
+	//
+	// Event Storage
+	//
+	// Events with their own memory, can be moved between the recording threads
+	// and the exporter by swapping pointers.
+	//
+
+	struct EventStorage
+	{
+		CaptureArena_t			arena;
+		SyncEventBuffer			events	{arena};
+	};
+
+
+
+	//
+	// Capture Exporter
+	//
+	// Captured events are merged, resolved and saved by the background thread,
+	// so stopping the capture doesn't block the application.
+	// Graphs are rendered by graphviz processes in parallel.
+	// Event storages are reused between captures.
+	//
+
+	class CaptureExporter
+	{
+	// types
+	public:
+		struct Capture
+		{
+			Array<UniquePtr<EventStorage>>	buffers;		// events of threads or frames, thread and queue names are stored in buffers too
+		};
+
+	private:
+		using StoragePool_t	= Array< UniquePtr<EventStorage> >;
+		using CaptureQueue_t	= std::deque< Capture >;
+
+		static constexpr uint	_maxRenderProcesses	= 2;
+		static constexpr uint	_renderTimeoutMS	= 30'000;
+
+
+	// variables
+	private:
+		std::mutex					_poolGuard;
+		StoragePool_t				_pool;
+
+		std::mutex					_queueGuard;		// protects '_queue', '_looping' and '_thread'
+		std::condition_variable		_wakeCV;
+		CaptureQueue_t				_queue;
+		bool						_looping		= false;
+		std::thread					_thread;			// started at first export
+
+		CaptureArena_t				_captureArena;		// used by the exporter thread
+		SyncEventBuffer				_capture		{_captureArena};
+
+		static inline std::atomic<uint>	_captureIndex	{0};	// shared by exporters of all instances, so file names are unique
+
+		ProcessPool					_renderer		{_maxRenderProcesses};
+
+
+	// methods
+	public:
+		CaptureExporter ();
+		~CaptureExporter ();
+
+		CaptureExporter (const CaptureExporter &) = delete;
+		CaptureExporter&  operator = (const CaptureExporter &) = delete;
+
+		// thread safe, returns empty storage
+		ND_ UniquePtr<EventStorage>  AcquireStorage ();
+
+		// thread safe, returns immediately, 'capture' is exported by the background thread
+		void  Export (Capture &&capture);
+
+	private:
+		void  _ExportLoop ();
+		void  _Export (Capture &capture);
+		void  _Merge (const Capture &capture);
+		void  _ReleaseStorage (UniquePtr<EventStorage> &&storage);
+		void  _LogMemoryUsage (const Capture &capture) const;
+
+		bool  _SaveDotFile_v1 (StringView filepath) const;
+		void  _Visualize (StringView filepath);
+	};
+
+
+}	// VSA
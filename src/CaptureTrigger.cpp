@@ -0,0 +1,203 @@
+// Copyright (c) 2019,  Zhirnov Andrey. For more information see 'LICENSE'
+
+#include "src/CaptureTrigger.h"
+#include "src/LayerSettings.h"
+#include "stl/Algorithms/StringUtils.h"
+
+#include <filesystem>
+
+#ifndef PLATFORM_WINDOWS
+#	include <signal.h>
+#endif
+
+namespace VSA
+{
+namespace
+{
+/*
+=================================================
+	OnCaptureSignal
+----
+	lock-free atomic is async-signal-safe
+=================================================
+*/
+#ifndef PLATFORM_WINDOWS
+	void  OnCaptureSignal (int)
+	{
+		CaptureTrigger::Request();
+	}
+
+	// there is only one trigger in the process, see 'LayerManager'
+	struct sigaction	s_prevAction = {};
+#endif
+
+}	// namespace
+//-----------------------------------------------------------------------------
+
+
+/*
+=================================================
+	constructor
+=================================================
+*/
+	CaptureTrigger::CaptureTrigger ()
+	{
+		_InstallSignalHandler();
+	}
+
+/*
+=================================================
+	destructor
+=================================================
+*/
+	CaptureTrigger::~CaptureTrigger ()
+	{
+		StopPolling();
+		_RestoreSignalHandler();
+	}
+
+/*
+=================================================
+	_InstallSignalHandler
+----
+	application handler is not overridden
+=================================================
+*/
+	void  CaptureTrigger::_InstallSignalHandler ()
+	{
+	#ifndef PLATFORM_WINDOWS
+		const int	sig = int(LayerSettings::Get().captureSignal);
+		if ( sig == 0 )
+			return;
+
+		struct sigaction	prev = {};
+		if ( ::sigaction( sig, null, OUT &prev ) != 0 )
+		{
+			VSA_LOGI( String(VSA_LAYER_NAME) << ": invalid capture signal " << ToString( sig ));
+			return;
+		}
+
+		if ( (prev.sa_flags & SA_SIGINFO) or prev.sa_handler != SIG_DFL )
+		{
+			VSA_LOGI( String(VSA_LAYER_NAME) << ": signal " << ToString( sig ) << " is used by the application, capture trigger is disabled" );
+			return;
+		}
+
+		struct sigaction	act = {};
+		act.sa_handler	= &OnCaptureSignal;
+		act.sa_flags	= SA_RESTART;
+		::sigemptyset( OUT &act.sa_mask );
+
+		_signalInstalled = (::sigaction( sig, &act, null ) == 0);
+		s_prevAction	 = prev;
+		CHECK( _signalInstalled );
+	#endif
+	}
+
+/*
+=================================================
+	_RestoreSignalHandler
+----
+	handler must not point into the layer after it is unloaded
+=================================================
+*/
+	void  CaptureTrigger::_RestoreSignalHandler ()
+	{
+	#ifndef PLATFORM_WINDOWS
+		if ( not _signalInstalled )
+			return;
+
+		const int	sig = int(LayerSettings::Get().captureSignal);
+		CHECK( ::sigaction( sig, &s_prevAction, null ) == 0 );
+		_signalInstalled = false;
+	#endif
+	}
+
+/*
+=================================================
+	StartPolling
+=================================================
+*/
+	void  CaptureTrigger::StartPolling ()
+	{
+		if ( LayerSettings::Get().controlFile.empty() )
+			return;
+
+		EXLOCK( _guard );
+		if ( _poller.joinable() )
+			return;
+
+		_looping	= true;
+		_poller		= std::thread{ [this] () { _PollLoop(); }};
+	}
+
+/*
+=================================================
+	StopPolling
+=================================================
+*/
+	void  CaptureTrigger::StopPolling ()
+	{
+		std::thread		poller;
+		{
+			EXLOCK( _guard );
+			_looping	= false;
+			poller		= std::move( _poller );
+		}
+		_wakeCV.notify_one();
+
+		if ( poller.joinable() )
+			poller.join();
+	}
+
+/*
+=================================================
+	_PollLoop
+=================================================
+*/
+	void  CaptureTrigger::_PollLoop ()
+	{
+		const String&	path = LayerSettings::Get().controlFile;
+
+		for (;;)
+		{
+			{
+				std::unique_lock	lock{ _guard };
+				if ( _wakeCV.wait_for( lock, std::chrono::milliseconds{_pollIntervalMS}, [this] () { return not _looping; }))
+					return;
+			}
+
+			if ( not _CheckControlFile( path ))
+				return;
+		}
+	}
+
+/*
+=================================================
+	_CheckControlFile
+----
+	file is removed to trigger the capture only once,
+	returns false if polling must be stopped.
+=================================================
+*/
+	bool  CaptureTrigger::_CheckControlFile (StringView path)
+	{
+		namespace FS = std::filesystem;
+
+		std::error_code	err;
+		if ( not FS::exists( FS::path{ path }, OUT err ))
+			return true;
+
+		if ( not FS::remove( FS::path{ path }, OUT err ))
+		{
+			VSA_LOGI( String(VSA_LAYER_NAME) << ": failed to remove control file '" << path << "', capture trigger is disabled" );
+			return false;
+		}
+
+		VSA_LOGI( String(VSA_LAYER_NAME) << ": capture is triggered by control file" );
+		Request();
+		return true;
+	}
+
+
+}	// VSA
@@ -0,0 +1,83 @@
+// Copyright (c) 2019,  Zhirnov Andrey. For more information see 'LICENSE'
+
+#pragma once
+
+#include "stl/Common.h"
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace VSA
+{
+
+	//
+	// Capture Trigger
+	//
+	// Input-free triggers for headless runs: POSIX signal and control file.
+	// Both increment the same process-wide counter, each layer instance keeps the last
+	// consumed value, so every instance captures once per request and the check on
+	// present is a relaxed load of the shared counter compared with the cached value.
+	// Signal trigger is disabled unless 'VSA_CAPTURE_SIGNAL' is set.
+	// Control file is polled by the background thread while any device exists.
+	// Previous signal action is restored in destructor, before the layer is unloaded.
+	//
+
+	class CaptureTrigger
+	{
+	// types
+	private:
+		static constexpr uint	_pollIntervalMS	= 250;
+
+
+	// variables
+	private:
+		static inline std::atomic<uint>	_requested	{0};	// number of requests in the process
+		bool							_signalInstalled = false;
+
+		std::mutex					_guard;			// protects '_looping' and '_poller'
+		std::condition_variable		_wakeCV;
+		bool						_looping	= false;
+		std::thread					_poller;
+
+
+	// methods
+	public:
+		CaptureTrigger ();
+		~CaptureTrigger ();
+
+		CaptureTrigger (const CaptureTrigger &) = delete;
+		CaptureTrigger&  operator = (const CaptureTrigger &) = delete;
+
+		// lock-free, returns true once for each request,
+		// 'consumed' must be initialized by 'RequestCount()', it is written only when request is consumed
+		ND_ static bool  Consume (INOUT std::atomic<uint> &consumed)
+		{
+			const uint	cur  = _requested.load( std::memory_order_relaxed );
+			uint		last = consumed.load( std::memory_order_relaxed );
+
+			if ( cur == last )
+				return false;
+
+			return consumed.compare_exchange_strong( INOUT last, cur, std::memory_order_relaxed );
+		}
+
+		ND_ static uint  RequestCount ()	{ return _requested.load( std::memory_order_relaxed ); }
+
+		// async-signal-safe
+		static void  Request ()				{ _requested.fetch_add( 1, std::memory_order_relaxed ); }
+
+		// does nothing if control file is not specified
+		void  StartPolling ();
+		void  StopPolling ();
+
+	private:
+		void  _InstallSignalHandler ();
+		void  _RestoreSignalHandler ();
+		void  _PollLoop ();
+		ND_ bool  _CheckControlFile (StringView path);
+	};
+
+
+}	// VSA
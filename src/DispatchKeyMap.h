@@ -0,0 +1,143 @@
+// Copyright (c) 2019,  Zhirnov Andrey. For more information see 'LICENSE'
+
+#pragma once
+
+#include "stl/Common.h"
+#include "stl/Math/BitMath.h"
+#include "stl/Algorithms/Cast.h"
+#include <atomic>
+
+namespace VSA
+{
+
+/*
+=================================================
+	DispatchKey
+----
+	the loader writes pointer to the dispatch table at the beginning of each dispatchable object,
+	instance and physical devices share the same key, device, queues and command buffers share the same key.
+=================================================
+*/
+	template <typename T>
+	ND_ inline const void*  DispatchKey (T handle)
+	{
+		STATIC_ASSERT( std::is_pointer_v<T> );
+		return *BitCast<const void* const*>( handle );
+	}
+
+
+
+	//
+	// Dispatch Key Map
+	//
+	// Lock-free reading, writing must be externally synchronized.
+	// Removed keys are kept as tombstones until the slot is reused,
+	// values are not owned by the map.
+	//
+
+	template <typename T, size_t Size = 64>
+	class DispatchKeyMap
+	{
+		STATIC_ASSERT( IsPowerOfTwo( Size ));
+
+	// types
+	private:
+		struct Slot
+		{
+			std::atomic<const void*>	key		{null};		// null - empty slot, never reset after first use
+			std::atomic<T *>			value	{null};		// null - removed
+		};
+
+		static constexpr size_t		_Mask	= Size - 1;
+
+
+	// variables
+	private:
+		Slot		_slots [Size];
+
+
+	// methods
+	public:
+		DispatchKeyMap () {}
+
+		DispatchKeyMap (const DispatchKeyMap &) = delete;
+		DispatchKeyMap&  operator = (const DispatchKeyMap &) = delete;
+
+		// thread safe
+		ND_ T*  Find (const void* key) const
+		{
+			for (size_t i = 0, idx = _Hash( key ); i < Size; ++i, idx = (idx + 1) & _Mask)
+			{
+				const void*	k = _slots[idx].key.load( std::memory_order_acquire );
+
+				if ( k == key )
+					return _slots[idx].value.load( std::memory_order_acquire );
+
+				if ( k == null )
+					break;
+			}
+			return null;
+		}
+
+		// requires external synchronization
+		bool  Insert (const void* key, T* value)
+		{
+			CHECK_ERR( key and value );
+
+			Slot*	free_slot = null;
+
+			for (size_t i = 0, idx = _Hash( key ); i < Size; ++i, idx = (idx + 1) & _Mask)
+			{
+				auto&		slot	= _slots[idx];
+				const void*	k		= slot.key.load( std::memory_order_relaxed );
+
+				if ( k == key )
+				{
+					slot.value.store( value, std::memory_order_release );
+					return true;
+				}
+
+				if ( not free_slot and (k == null or slot.value.load( std::memory_order_relaxed ) == null) )
+					free_slot = &slot;
+
+				if ( k == null )
+					break;
+			}
+
+			CHECK_ERR( free_slot );
+
+			// value is visible before the key, the old key of reused slot must not be used by other threads
+			free_slot->value.store( value, std::memory_order_release );
+			free_slot->key.store( key, std::memory_order_release );
+			return true;
+		}
+
+		// requires external synchronization
+		void  Erase (const void* key)
+		{
+			for (size_t i = 0, idx = _Hash( key ); i < Size; ++i, idx = (idx + 1) & _Mask)
+			{
+				const void*	k = _slots[idx].key.load( std::memory_order_relaxed );
+
+				if ( k == key )
+				{
+					_slots[idx].value.store( null, std::memory_order_release );
+					return;
+				}
+
+				if ( k == null )
+					return;
+			}
+		}
+
+	private:
+		ND_ static size_t  _Hash (const void* key)
+		{
+			// dispatch tables are heap allocated, low bits are always zero
+			const size_t	h = size_t(key) >> 4;
+			return (h ^ (h >> 7) ^ (h >> 15)) & _Mask;
+		}
+	};
+
+
+}	// VSA
@@ -4,10 +4,26 @@
 
 #include "vulkan/vulkan.h"
 #include "stl/Common.h"
+#include "stl/Platforms/PerformanceCounter.h"
 
 namespace VSA
 {
 
+	//
+	// Call Entry Time
+	//
+	// Sync functions store 'PerformanceCounter::Now()' here before calling the next layer,
+	// callbacks are invoked later on the same thread, so the analyzer gets both entry and exit time.
+	// Zero if capturing was started while the function was executing.
+	//
+
+	ND_ inline uint64_t&  CallEntryTime ()
+	{
+		static thread_local uint64_t	time = 0;
+		return time;
+	}
+
+
 	//
 	// Analyzer interface
 	//
@@ -22,6 +38,13 @@ namespace VSA
 
 		virtual void Start () = 0;
 		virtual void Stop () = 0;
+
+		// record continuously and keep only last frames, 'Dump()' exports them
+		virtual void StartFlightRecorder (uint frames) = 0;
+		virtual void Dump () = 0;
+
+		// called by present or by frame delimiter when capture is started
+		virtual void EndFrame () = 0;
 	};
 
 
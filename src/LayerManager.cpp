@@ -2,9 +2,12 @@
 
 #include "src/LayerManager.h"
 #include "src/SyncAnalyzer.h"
+#include "src/LayerSettings.h"
+#include "include/vk_layer_sync_analyzer.h"
 
 #include "stl/Containers/Singleton.h"
 #include "stl/Algorithms/StringUtils.h"
+#include "stl/CompileTime/PerfectHash.h"
 
 #include "vulkan/vk_layer.h"
 
@@ -16,13 +19,140 @@ namespace VSA
 		1,
 		"sync analysis layer",
 	};
+
+namespace
+{
+/*
+=================================================
+	Listener_*
+----
+	'Has<T>' is true if analyzer 'T' has 'vki_*' method for the entry point,
+	functions with result take it as the last argument.
+=================================================
+*/
+	#define VISITOR( _name_ ) \
+		struct Listener_ ## _name_ \
+		{ \
+			template <typename T, typename = void>	struct Has : std::false_type {}; \
+			template <typename T>					struct Has< T, std::void_t< decltype(&T::vki_ ## _name_) >> : std::true_type {}; \
+			\
+			template <typename T, typename ...Args> \
+			forceinline static void  Invoke (T &an, const Args& ...args) { an.vki_ ## _name_( args... ); } \
+		};
+	INSTANCE_FN_LIST( VISITOR )
+	DEVICE_FN_LIST( VISITOR )
+	#undef VISITOR
+
+	template <typename L, typename TL>
+	struct HasListener;
+
+	template <typename L, typename ...Types>
+	struct HasListener< L, TypeList< Types... >> {
+		static constexpr bool	value = (L::template Has< Types >::value or ...);
+	};
+
+}	// namespace
+
+	
+/*
+=================================================
+	InstanceFnTable / DeviceFnTable
+----
+	'*Procs' have the same order as '*FnNames'
+=================================================
+*/
+	#define VISITOR( _name_ )	"vk" #_name_,
+	static constexpr StringView		InstanceFnNames[] = {
+		INSTANCE_FN_LIST( VISITOR )
+		"vkGetInstanceProcAddr",
+		"vkGetDeviceProcAddr",
+		"vkEnumerateInstanceLayerProperties",
+		"vkEnumerateInstanceExtensionProperties",
+		"vkEnumerateDeviceLayerProperties",
+		#ifdef VK_USE_PLATFORM_WIN32_KHR
+		"vkCreateWin32SurfaceKHR",
+		#endif
+	};
+
+	static constexpr StringView		DeviceFnNames[] = {
+		DEVICE_FN_LIST( VISITOR )
+		LAYER_FN_LIST( VISITOR )
+	};
+	#undef VISITOR
+
+	#define VISITOR( _name_ )	BitCast<PFN_vkVoidFunction>( &LayerManager::vki_ ## _name_ ),
+	static const PFN_vkVoidFunction	InstanceProcs[] = {
+		INSTANCE_FN_LIST( VISITOR )
+		VISITOR( GetInstanceProcAddr )
+		VISITOR( GetDeviceProcAddr )
+		VISITOR( EnumerateInstanceLayerProperties )
+		VISITOR( EnumerateInstanceExtensionProperties )
+		VISITOR( EnumerateDeviceLayerProperties )
+		#ifdef VK_USE_PLATFORM_WIN32_KHR
+		VISITOR( CreateWin32SurfaceKHR )
+		#endif
+	};
+
+	static const PFN_vkVoidFunction	DeviceProcs[] = {
+		DEVICE_FN_LIST( VISITOR )
+		LAYER_FN_LIST( VISITOR )
+	};
+	#undef VISITOR
+
+	static constexpr StaticPerfectHash< CountOf( InstanceFnNames )>	InstanceFnTable	{ InstanceFnNames };
+	static constexpr StaticPerfectHash< CountOf( DeviceFnNames )>	DeviceFnTable	{ DeviceFnNames };
+
+	STATIC_ASSERT( InstanceFnTable.IsValid() and DeviceFnTable.IsValid() );
+	STATIC_ASSERT( CountOf( InstanceFnNames ) == CountOf( InstanceProcs ));
+	STATIC_ASSERT( CountOf( DeviceFnNames ) == CountOf( DeviceProcs ));
+
+	// layer functions must match the application interface
+	#define VISITOR( _name_ )	STATIC_ASSERT( IsSameTypes< PFN_vk ## _name_, decltype(&LayerManager::vki_ ## _name_) >);
+	LAYER_FN_LIST( VISITOR )
+	#undef VISITOR
+	
+/*
+=================================================
+	_Call
+----
+	calls 'vki_*' method of all enabled analyzers that have it
+=================================================
+*/
+	template <typename L, typename ...Args>
+	forceinline void  LayerManager::LayerInstance::_Call (const Args& ...args) const
+	{
+		if constexpr( HasListener< L, AnalyzerTypes_t >::value )
+			_CallListeners<L>( std::make_index_sequence< AnalyzerTypes_t::Count >{}, args... );
+	}
+	
+	template <typename L, size_t ...I, typename ...Args>
+	forceinline void  LayerManager::LayerInstance::_CallListeners (std::index_sequence<I...>, const Args& ...args) const
+	{
+		const uint	enabled	= _enabledListeners.load( std::memory_order_relaxed );
+
+		const auto	CallOne	= [&] (auto index)
+		{
+			constexpr size_t	idx = decltype(index)::value;
+			using T = typename AnalyzerTypes_t::template Get< idx >;
+
+			if constexpr( L::template Has< T >::value )
+			{
+				if ( enabled & (1u << idx) )
+					L::Invoke( *std::get< idx >( _listeners ), args... );
+			}
+		};
+		( CallOne( std::integral_constant< size_t, I >{} ), ... );
+	}
 	
 /*
 =================================================
 	constructor
 =================================================
 */
-	LayerManager::LayerInstance::LayerInstance ()
+	LayerManager::LayerInstance::LayerInstance () :
+		_framesToTrigger{ LayerSettings::Get().captureStartFrame },
+		_consumedTriggers{ CaptureTrigger::RequestCount() },
+		_frameSubmits{ LayerSettings::Get().frameSubmits }
 	{
 		_RegisterSyncAnalyzer();
 	}
@@ -32,15 +162,84 @@ namespace VSA
 	_Start
 =================================================
 */
-	void LayerManager::LayerInstance::_Start (uint frames)
+	bool LayerManager::LayerInstance::_Start (uint frames)
 	{
-		_capturedFrames = frames;
+		EXLOCK( _controlGuard );
+
+		if ( IsStarted() )
+			return false;
 
 		for (auto& an : _analyzers) {
 			an->Start();
 		}
+
+		// open the gate only when all analyzers are ready
+		_capturedFrames.store( int(Min( frames, uint(std::numeric_limits<int>::max()) )), std::memory_order_release );
+		return true;
+	}
+
+/*
+=================================================
+	_Stop
+----
+	does nothing in flight recorder mode
+=================================================
+*/
+	bool LayerManager::LayerInstance::_Stop ()
+	{
+		EXLOCK( _controlGuard );
+
+		int	frames = _capturedFrames.load( std::memory_order_relaxed );
+		for (;;)
+		{
+			if ( frames <= 0 )
+				return false;
+
+			if ( _capturedFrames.compare_exchange_weak( INOUT frames, 0, std::memory_order_acq_rel, std::memory_order_relaxed ))
+				break;
+		}
+
+		for (auto& an : _analyzers) {
+			an->Stop();
+		}
+		return true;
+	}
+	
+/*
+=================================================
+	_StartFlightRecorder
+=================================================
+*/
+	void LayerManager::LayerInstance::_StartFlightRecorder (uint frames)
+	{
+		EXLOCK( _controlGuard );
+
+		// started once per instance, next devices are recorded into the same ring
+		if ( IsStarted() )
+			return;
+
+		for (auto& an : _analyzers) {
+			an->StartFlightRecorder( frames );
+		}
+
+		// gate stays open until the device is destroyed
+		_capturedFrames.store( -1, std::memory_order_release );
 	}
 	
+/*
+=================================================
+	_Dump
+=================================================
+*/
+	void LayerManager::LayerInstance::_Dump ()
+	{
+		EXLOCK( _controlGuard );
+
+		for (auto& an : _analyzers) {
+			an->Dump();
+		}
+	}
+
 /*
 =================================================
 	_Update
@@ -48,17 +247,143 @@ namespace VSA
 */
 	void LayerManager::LayerInstance::_Update ()
 	{
-		if ( _capturedFrames < 0 )
+		// each trigger costs one atomic load when it is not fired
+		if ( CaptureTrigger::Consume( INOUT _consumedTriggers ))
+		{
+			_OnCaptureKey();
 			return;
+		}
+
+		if ( uint n = _framesToTrigger.load( std::memory_order_relaxed ); n > 0 )
+		{
+			if ( _framesToTrigger.compare_exchange_strong( INOUT n, n - 1, std::memory_order_relaxed ) and n == 1 )
+			{
+				VSA_LOGI( String(VSA_LAYER_NAME) << ": capture is triggered by frame index" );
+				_OnCaptureKey();
+				return;
+			}
+		}
+
+		// frames are not counted in flight recorder mode
+		int	frames = _capturedFrames.load( std::memory_order_relaxed );
 
-		if ( (--_capturedFrames) == 0 )
+		while ( frames > 1 )
+		{
+			if ( _capturedFrames.compare_exchange_weak( INOUT frames, frames - 1, std::memory_order_acq_rel, std::memory_order_relaxed ))
+				return;
+		}
+
+		// last frame, '_Stop' doesn't race with '_Start' from other thread
+		if ( frames == 1 )
+			_Stop();
+	}
+
+/*
+=================================================
+	_OnCaptureKey
+----
+	called by hotkey, signal, control file or frame index
+=================================================
+*/
+	void LayerManager::LayerInstance::_OnCaptureKey ()
+	{
+		if ( IsFlightRecorder() )
+			_Dump();
+		else
+			_Start( Max( LayerSettings::Get().captureFrames, 1u ));
+	}
+
+/*
+=================================================
+	_EndFrame
+----
+	called by present and by frame delimiters
+=================================================
+*/
+	void LayerManager::LayerInstance::_EndFrame ()
+	{
+		if ( IsStarted() )
 		{
 			for (auto& an : _analyzers) {
-				an->Stop();
+				an->EndFrame();
+			}
+		}
+		_Update();
+	}
+
+/*
+=================================================
+	_OnSubmit
+=================================================
+*/
+	void LayerManager::LayerInstance::_OnSubmit ()
+	{
+		if ( _frameSubmits == 0 )
+			return;
+
+		if ( (_submitCounter.fetch_add( 1, std::memory_order_relaxed ) + 1) % _frameSubmits == 0 )
+			_EndFrame();
+	}
+
+/*
+=================================================
+	_OnInsertLabel
+=================================================
+*/
+	void LayerManager::LayerInstance::_OnInsertLabel (const VkDebugUtilsLabelEXT* pLabelInfo)
+	{
+		const String&	label = LayerSettings::Get().frameLabel;
+
+		if ( label.size() and pLabelInfo and pLabelInfo->pLabelName and label == pLabelInfo->pLabelName )
+			_EndFrame();
+	}
+
+/*
+=================================================
+	_OnWaitForFences
+----
+	if 'waitAll' is false, it is unknown which fence was signaled
+=================================================
+*/
+	void LayerManager::LayerInstance::_OnWaitForFences (uint fenceCount, const VkFence* pFences, VkBool32 waitAll)
+	{
+		const uint64_t	fence = _frameFence.load( std::memory_order_relaxed );
+
+		if ( fence == 0 or not (waitAll or fenceCount == 1) )
+			return;
+
+		for (uint i = 0; i < fenceCount; ++i)
+		{
+			if ( HandleToU64( pFences[i] ) == fence )
+			{
+				_EndFrame();
+				return;
 			}
 		}
 	}
 
+/*
+=================================================
+	_OnSetFenceName
+=================================================
+*/
+	void LayerManager::LayerInstance::_OnSetFenceName (uint64_t fence, const char* name)
+	{
+		const String&	frame_fence = LayerSettings::Get().frameFence;
+
+		if ( frame_fence.empty() )
+			return;
+
+		if ( name and frame_fence == name )
+			_frameFence.store( fence, std::memory_order_relaxed );
+		else
+		{
+			// fence was renamed
+			uint64_t	expected = fence;
+			_frameFence.compare_exchange_strong( INOUT expected, 0, std::memory_order_relaxed );
+		}
+	}
+
 /*
 =================================================
 	_Init1
@@ -87,18 +412,47 @@ namespace VSA
 	_Init2
 =================================================
 */
-	void LayerManager::LayerInstance::_Init2 (VkPhysicalDevice pd, VkDevice ld, PFN_vkGetDeviceProcAddr gpa)
+	void LayerManager::LayerInstance::_Init2 (LayerDevice &dev)
 	{
-		_physicalDevice		= pd;
-		_logicalDevice		= ld;
-		_getDeviceProcAddr	= gpa;
+		auto&		dev_fn	= dev._devFn;
+		auto&		procs	= dev._deviceProcs;
+		const auto	gpa		= dev._getDeviceProcAddr;
+		const auto	ld		= dev._logicalDevice;
+
+		#define VISITOR( _name_ )	dev_fn._name_ = BitCast<PFN_vk ## _name_>(gpa( ld, "vk" #_name_ ));
+		DEVICE_FN_LIST( VISITOR )
+		#undef VISITOR
 
-		#define VISITOR( _name_ )	_devFn._name_ = BitCast<PFN_vk ## _name_>(gpa( ld, "vk" #_name_ ));
+		// function from the next layer is used if no analyzer has method for this entry point,
+		// so interception costs nothing. 'vkDestroyDevice' is always intercepted to unregister the device.
+		size_t	idx = 0;
+		#define VISITOR( _name_ ) \
+			procs[idx++] = (HasListener< Listener_ ## _name_, AnalyzerTypes_t >::value or IsSameTypes< Listener_ ## _name_, Listener_DestroyDevice >) ? \
+							BitCast<PFN_vkVoidFunction>( &LayerManager::vki_ ## _name_ ) : \
+							BitCast<PFN_vkVoidFunction>( dev_fn._name_._fn );
 		DEVICE_FN_LIST( VISITOR )
 		#undef VISITOR
+
+		// functions used by the layer itself are intercepted even if no analyzer listens to them
+		const auto	Intercept = [&procs] (bool enable, StringView name, auto nextFn, auto layerFn)
+		{
+			if ( enable and nextFn )
+				procs[ DeviceFnTable.Find( name )] = BitCast<PFN_vkVoidFunction>( layerFn );
+		};
+		const auto&	settings = LayerSettings::Get();
+
+		// present ends the frame and checks capture triggers
+		Intercept( true, "vkQueuePresentKHR", dev_fn.QueuePresentKHR, &LayerManager::vki_QueuePresentKHR );
+
+		// frame delimiters for applications without swapchain
+		Intercept( not settings.frameLabel.empty(), "vkQueueInsertDebugUtilsLabelEXT", dev_fn.QueueInsertDebugUtilsLabelEXT, &LayerManager::vki_QueueInsertDebugUtilsLabelEXT );
+		Intercept( settings.frameSubmits > 0, "vkQueueSubmit", dev_fn.QueueSubmit, &LayerManager::vki_QueueSubmit );
+		Intercept( not settings.frameFence.empty(), "vkWaitForFences", dev_fn.WaitForFences, &LayerManager::vki_WaitForFences );
+		Intercept( not settings.frameFence.empty(), "vkSetDebugUtilsObjectNameEXT", dev_fn.SetDebugUtilsObjectNameEXT, &LayerManager::vki_SetDebugUtilsObjectNameEXT );
+		Intercept( not settings.frameFence.empty(), "vkDebugMarkerSetObjectNameEXT", dev_fn.DebugMarkerSetObjectNameEXT, &LayerManager::vki_DebugMarkerSetObjectNameEXT );
 			
 		for (auto& an : _analyzers) {
-			an->OnCreateDevice( _instance, _physicalDevice, _logicalDevice, _getInstanceProcAddr, _getDeviceProcAddr );
+			an->OnCreateDevice( _instance, dev._physicalDevice, ld, _getInstanceProcAddr, gpa );
 		}
 	}
 	
@@ -111,35 +465,7 @@ namespace VSA
 	{
 		auto	sa = MakeShared<SyncAnalyzer>();
 
-		#define ADD_CB( _name_ ) \
-			_fnTable._name_.push_back( [sa] (const auto& argsInTuple) { \
-				std::apply( [sa] (auto... args) { sa->vki_ ## _name_( std::forward<decltype(args)>(args)... ); }, \
-						    argsInTuple ); \
-			})
-		#define ADD_CB2( _name_ ) \
-			_fnTable._name_.push_back( [sa] (const auto& argsInTuple, VkResult res) { \
-				std::apply( [sa, res] (auto... args) { sa->vki_ ## _name_( std::forward<decltype(args)>(args)..., res ); }, \
-						    argsInTuple ); \
-			})
-
-		ADD_CB( GetDeviceQueue );
-		ADD_CB( GetDeviceQueue2 );
-		ADD_CB2( QueueSubmit );
-		ADD_CB2( QueueWaitIdle );
-		ADD_CB2( DeviceWaitIdle );
-		ADD_CB2( QueueBindSparse );
-		ADD_CB2( ResetFences );
-		ADD_CB2( GetFenceStatus );
-		ADD_CB2( WaitForFences );
-		ADD_CB2( AcquireNextImageKHR );
-		ADD_CB2( AcquireNextImage2KHR );
-		ADD_CB2( QueuePresentKHR );
-		ADD_CB2( DebugMarkerSetObjectNameEXT );
-		ADD_CB2( SetDebugUtilsObjectNameEXT );
-
-		#undef ADD_CB
-		#undef ADD_CB2
-
+		std::get< SharedPtr<SyncAnalyzer> >( _listeners ) = sa;
 		_analyzers.push_back( sa );
 	}
 //-----------------------------------------------------------------------------
@@ -157,25 +483,6 @@ namespace VSA
 											::GetModuleHandle( LPCSTR(null) ), ::GetCurrentThreadId() );
 			CHECK( _wndHook );
 		#endif
-
-		#define VISITOR( _name_ )	_instanceTable["vk" #_name_ ] = BitCast<PFN_vkVoidFunction>( &vki_ ## _name_ );
-		INSTANCE_FN_LIST( VISITOR )
-		#undef VISITOR
-		
-		_instanceTable["vkGetInstanceProcAddr" ] = BitCast<PFN_vkVoidFunction>( &vki_GetInstanceProcAddr );
-		_instanceTable["vkGetDeviceProcAddr" ] = BitCast<PFN_vkVoidFunction>( &vki_GetDeviceProcAddr );
-		_instanceTable["vkEnumerateDeviceExtensionProperties" ] = BitCast<PFN_vkVoidFunction>( &vki_EnumerateDeviceExtensionProperties );
-		_instanceTable["vkEnumerateInstanceLayerProperties" ] = BitCast<PFN_vkVoidFunction>( &vki_EnumerateInstanceLayerProperties );
-		_instanceTable["vkEnumerateInstanceExtensionProperties" ] = BitCast<PFN_vkVoidFunction>( &vki_EnumerateInstanceExtensionProperties );
-		_instanceTable["vkEnumerateDeviceLayerProperties" ] = BitCast<PFN_vkVoidFunction>( &vki_EnumerateDeviceLayerProperties );
-
-		#ifdef VK_USE_PLATFORM_WIN32_KHR
-		_instanceTable["vkCreateWin32SurfaceKHR"] = BitCast<PFN_vkVoidFunction>( &vki_CreateWin32SurfaceKHR );
-		#endif
-			
-		#define VISITOR( _name_ )	_deviceTable["vk" #_name_ ] = BitCast<PFN_vkVoidFunction>( &vki_ ## _name_ );
-		DEVICE_FN_LIST( VISITOR )
-		#undef VISITOR
 	}
 
 /*
@@ -196,11 +503,10 @@ namespace VSA
 	GetInstanceFn
 =================================================
 */
-	PFN_vkVoidFunction  LayerManager::GetInstanceFn (const String &name) const
+	PFN_vkVoidFunction  LayerManager::GetInstanceFn (StringView name)
 	{
-		EXLOCK( _lock );
-		auto	iter = _instanceTable.find( name );
-		return iter != _instanceTable.end() ? iter->second : null;
+		const size_t	idx = InstanceFnTable.Find( name );
+		return idx < CountOf( InstanceProcs ) ? InstanceProcs[idx] : null;
 	}
 	
 /*
@@ -208,11 +514,10 @@ namespace VSA
 	GetDeviceFn
 =================================================
 */
-	PFN_vkVoidFunction  LayerManager::GetDeviceFn (const String &name) const
+	PFN_vkVoidFunction  LayerManager::GetDeviceFn (StringView name)
 	{
-		EXLOCK( _lock );
-		auto	iter = _deviceTable.find( name );
-		return iter != _deviceTable.end() ? iter->second : null;
+		const size_t	idx = DeviceFnTable.Find( name );
+		return idx < CountOf( DeviceProcs ) ? DeviceProcs[idx] : null;
 	}
 
 /*
@@ -230,44 +535,50 @@ namespace VSA
 	Layer
 =================================================
 */
-	LayerManager::LayerInstancePtr  LayerManager::Layer (VkInstance handle)
+	template <typename T>
+	inline LayerManager::LayerInstance*  LayerManager::_FindLayer (T handle)
 	{
-		auto&	inst = Instance();
-		EXLOCK( inst._lock );
-		auto	iter = inst._instanceToLayer.find( handle );
-		return iter != inst._instanceToLayer.end() ? iter->second : null;
+		if ( handle == VK_NULL_HANDLE )
+			return null;
+
+		return Instance()._dispatchToLayer.Find( DispatchKey( handle ));
 	}
 
-	LayerManager::LayerInstancePtr  LayerManager::Layer (VkPhysicalDevice handle)
+	template <typename T>
+	inline LayerManager::LayerDevice*  LayerManager::_FindDevice (T handle)
 	{
-		auto&	inst = Instance();
-		EXLOCK( inst._lock );
-		auto	iter = inst._pdeviceToLayer.find( handle );
-		return iter != inst._pdeviceToLayer.end() ? iter->second : null;
+		if ( handle == VK_NULL_HANDLE )
+			return null;
+
+		return Instance()._dispatchToDevice.Find( DispatchKey( handle ));
 	}
 
-	LayerManager::LayerInstancePtr  LayerManager::Layer (VkDevice handle)
+	LayerManager::LayerInstance*  LayerManager::Layer (VkInstance handle)
 	{
-		auto&	inst = Instance();
-		EXLOCK( inst._lock );
-		auto	iter = inst._deviceToLayer.find( handle );
-		return iter != inst._deviceToLayer.end() ? iter->second : null;
+		return _FindLayer( handle );
 	}
 
-	LayerManager::LayerInstancePtr  LayerManager::Layer (VkQueue handle)
+	LayerManager::LayerInstance*  LayerManager::Layer (VkPhysicalDevice handle)
 	{
-		auto&	inst = Instance();
-		EXLOCK( inst._lock );
-		auto	iter = inst._queueToLayer.find( handle );
-		return iter != inst._queueToLayer.end() ? iter->second : null;
+		return _FindLayer( handle );
 	}
 
-	LayerManager::LayerInstancePtr  LayerManager::Layer (VkCommandBuffer handle)
+	LayerManager::LayerInstance*  LayerManager::Layer (VkDevice handle)
 	{
-		auto&	inst = Instance();
-		EXLOCK( inst._lock );
-		auto	iter = inst._cmdBufferToLayer.find( handle );
-		return iter != inst._cmdBufferToLayer.end() ? iter->second : null;
+		auto	dev = _FindDevice( handle );
+		return dev ? dev->Layer() : null;
+	}
+
+	LayerManager::LayerInstance*  LayerManager::Layer (VkQueue handle)
+	{
+		auto	dev = _FindDevice( handle );
+		return dev ? dev->Layer() : null;
+	}
+
+	LayerManager::LayerInstance*  LayerManager::Layer (VkCommandBuffer handle)
+	{
+		auto	dev = _FindDevice( handle );
+		return dev ? dev->Layer() : null;
 	}
 	
 	LayerManager::LayerInstancePtr  LayerManager::LayerFromWnd (void* wnd)
@@ -315,18 +626,6 @@ namespace VSA
 		return chain_info;
 	}
 	
-/*
-=================================================
-	Call
-=================================================
-*/
-	template <typename Fn, typename ...Args>
-	inline void Call (const Fn &listeners, Args&& ...args)
-	{
-		for (auto& fn : listeners) {
-			fn( std::forward<Args>(args)... );
-		}
-	}
 //-----------------------------------------------------------------------------
 
 
@@ -365,9 +664,9 @@ namespace VSA
 			EXLOCK( inst._lock );
 			auto	iter = inst._instanceToLayer.insert_or_assign( *pInstance, MakeShared<LayerInstance>() ).first;
 			iter->second->_Init1( *pInstance, get_instance_proc_addr );
+			CHECK( inst._dispatchToLayer.Insert( DispatchKey( *pInstance ), iter->second.get() ));
 			
-			Call( iter->second->_fnTable.CreateInstance,
-				  MakeTuple( pCreateInfo, pAllocator, pInstance ), result );
+			iter->second->_Call< Listener_CreateInstance >( pCreateInfo, pAllocator, pInstance, result );
 
 			VSA_LOGI( String(VSA_LAYER_NAME) << ": CreateInstance" );
 		}
@@ -384,15 +683,10 @@ namespace VSA
 		VkInstance                                  instance,
 		const char*                                 pName)
 	{
-		if ( pName and StringView{pName} == "vkCreateInstance" )
-		{
-			return BitCast<PFN_vkVoidFunction>( &vki_CreateInstance );
-		}
-
-		auto&	inst = Instance();
-		auto	res  = inst.GetInstanceFn( pName );
+		if ( not pName )
+			return null;
 
-		if ( res )
+		if ( auto res = GetInstanceFn( pName ))
 			return res;
 
 		if ( auto layer = Layer( instance ) )
@@ -412,15 +706,21 @@ namespace VSA
 		VkDevice                                    device,
 		const char*                                 pName)
 	{
-		auto&	inst = Instance();
-		auto	res  = inst.GetDeviceFn( pName );
+		if ( not pName )
+			return null;
 
-		if ( res )
-			return res;
+		const size_t	idx		= DeviceFnTable.Find( pName );
+		auto			dev		= _FindDevice( device );
 
-		if ( auto layer = Layer( device ) )
+		if ( idx < CountOf( DeviceProcs ))
 		{
-			return layer->DeviceProcAddr()( device, pName );
+			// function from the next layer may be null if extension is not enabled
+			return dev and idx < dev->_deviceProcs.size() ? dev->_deviceProcs[idx] : DeviceProcs[idx];
+		}
+
+		if ( dev )
+		{
+			return dev->DeviceProcAddr()( device, pName );
 		}
 
 		return null;
@@ -435,9 +735,15 @@ namespace VSA
 		VkInstance                                  instance,
 		const VkAllocationCallbacks*                pAllocator)
 	{
+		if ( instance == VK_NULL_HANDLE )
+			return;
+
+		// key is stored in the instance memory, it must be read before the instance is destroyed
+		const void*	key = DispatchKey( instance );
+
 		if ( auto layer = Layer( instance ) )
 		{
-			Call( layer->_fnTable.DestroyInstance, MakeTuple( instance, pAllocator ));
+			layer->_Call< Listener_DestroyInstance >( instance, pAllocator );
 			
 			VSA_LOGI( String(VSA_LAYER_NAME) << ": DestroyInstance" );
 
@@ -446,7 +752,20 @@ namespace VSA
 
 		auto&	inst = Instance();
 		EXLOCK( inst._lock );
-		inst._instanceToLayer.erase( instance );
+		inst._dispatchToLayer.Erase( key );
+
+		// surfaces may not be destroyed, so windows are released with the instance
+		if ( auto iter = inst._instanceToLayer.find( instance ); iter != inst._instanceToLayer.end() )
+		{
+			for (auto wnd = inst._windowToLayer.begin(); wnd != inst._windowToLayer.end();)
+			{
+				if ( wnd->second == iter->second )
+					wnd = inst._windowToLayer.erase( wnd );
+				else
+					++wnd;
+			}
+			inst._instanceToLayer.erase( iter );
+		}
 	}
 	
 /*
@@ -461,18 +780,8 @@ namespace VSA
 	{
 		if ( auto layer = Layer( instance ) )
 		{
-			VkResult result = layer->_instFn.EnumeratePhysicalDevices( instance, INOUT pPhysicalDeviceCount, OUT pPhysicalDevices );
-
-			if ( result == VK_SUCCESS and pPhysicalDevices )
-			{
-				auto&	inst = Instance();
-				EXLOCK( inst._lock );
-
-				for (uint i = 0; i < *pPhysicalDeviceCount; ++i) {
-					inst._pdeviceToLayer.insert_or_assign( pPhysicalDevices[i], layer );
-				}
-			}
-			return result;
+			// physical devices have the same dispatch key as the instance
+			return layer->_instFn.EnumeratePhysicalDevices( instance, INOUT pPhysicalDeviceCount, OUT pPhysicalDevices );
 		}
 		
 		CHECK( false );
@@ -605,16 +914,23 @@ namespace VSA
 		
 		if ( result == VK_SUCCESS and pDevice and *pDevice )
 		{
-			auto&	inst = Instance();
+			auto&	inst	= Instance();
+			auto	dev		= MakeUnique<LayerDevice>( layer->shared_from_this(), physicalDevice, *pDevice, get_device_proc_addr );
 			EXLOCK( inst._lock );
-			inst._deviceToLayer.insert_or_assign( *pDevice, layer );
-			layer->_Init2( physicalDevice, *pDevice, get_device_proc_addr );
+			layer->_Init2( *dev );
+
+			// queues and command buffers have the same dispatch key as the device
+			CHECK( inst._dispatchToDevice.Insert( DispatchKey( *pDevice ), dev.get() ));
+			inst._deviceToLayer.insert_or_assign( *pDevice, std::move(dev) );
+			inst._trigger.StartPolling();
 			
 			VSA_LOGI( String(VSA_LAYER_NAME) << ": CreateDevice" );
 		}
 
-		Call( layer->_fnTable.CreateDevice,
-				MakeTuple( physicalDevice, pCreateInfo, pAllocator, pDevice ), result );
+		layer->_Call< Listener_CreateDevice >( physicalDevice, pCreateInfo, pAllocator, pDevice, result );
+
+		if ( result == VK_SUCCESS and LayerSettings::Get().flightRecorderFrames > 0 )
+			layer->_StartFlightRecorder( LayerSettings::Get().flightRecorderFrames );
 
 		return result;
 	}
@@ -628,17 +944,26 @@ namespace VSA
 		VkDevice                                    device,
 		const VkAllocationCallbacks*                pAllocator)
 	{
-		if ( auto layer = Layer( device ) )
+		if ( auto dev = _FindDevice( device ) )
 		{
-			Call( layer->_fnTable.DestroyDevice, MakeTuple( device, pAllocator ));
+			auto	layer = dev->Layer();
+
+			layer->_Call< Listener_DestroyDevice >( device, pAllocator );
 
-			layer->_devFn.DestroyDevice( device, pAllocator );
+			// key is stored in the device memory, it must be read before the device is destroyed
+			const void*	key = DispatchKey( device );
+
+			dev->_devFn.DestroyDevice( device, pAllocator );
 			
 			VSA_LOGI( String(VSA_LAYER_NAME) << ": DestroyDevice" );
 
 			auto&	inst = Instance();
 			EXLOCK( inst._lock );
+			inst._dispatchToDevice.Erase( key );
 			inst._deviceToLayer.erase( device );
+
+			if ( inst._deviceToLayer.empty() )
+				inst._trigger.StopPolling();
 			return;
 		}
 
@@ -656,17 +981,15 @@ namespace VSA
 		uint32_t                                    queueIndex,
 		VkQueue*                                    pQueue)
 	{
-		if ( auto layer = Layer( device ) )
+		if ( auto dev = _FindDevice( device ) )
 		{
-			layer->_devFn.GetDeviceQueue( device, queueFamilyIndex, queueIndex, OUT pQueue );
+			auto	layer = dev->Layer();
+
+			dev->_devFn.GetDeviceQueue( device, queueFamilyIndex, queueIndex, OUT pQueue );
 
 			if ( pQueue and *pQueue )
 			{
-				Call( layer->_fnTable.GetDeviceQueue, MakeTuple( device, queueFamilyIndex, queueIndex, pQueue ));
-
-				auto&	inst = Instance();
-				EXLOCK( inst._lock );
-				inst._queueToLayer.insert_or_assign( *pQueue, layer );
+				layer->_Call< Listener_GetDeviceQueue >( device, queueFamilyIndex, queueIndex, pQueue );
 			}
 			return;
 		}
@@ -685,11 +1008,22 @@ namespace VSA
 		const VkSubmitInfo*                         pSubmits,
 		VkFence                                     fence)
 	{
-		if ( auto layer = Layer( queue ) )
+		if ( auto dev = _FindDevice( queue ) )
 		{
-			VkResult result = layer->_devFn.QueueSubmit( queue, submitCount, pSubmits, fence );
+			auto	layer = dev->Layer();
+
+			const uint64_t	entry_time	= layer->BeginCall();
+
+			VkResult result = dev->_devFn.QueueSubmit( queue, submitCount, pSubmits, fence );
+
+			if ( layer->IsStarted() )
+			{
+				CallEntryTime() = entry_time;
+				layer->_Call< Listener_QueueSubmit >( queue, submitCount, pSubmits, fence, result );
+			}
 
-			Call( layer->_fnTable.QueueSubmit, MakeTuple( queue, submitCount, pSubmits, fence ), result );
+			if ( result == VK_SUCCESS )
+				layer->_OnSubmit();
 
 			return result;
 		}
@@ -706,11 +1040,19 @@ namespace VSA
 	VKAPI_ATTR VkResult VKAPI_CALL LayerManager::vki_QueueWaitIdle(
 		VkQueue                                     queue)
 	{
-		if ( auto layer = Layer( queue ) )
+		if ( auto dev = _FindDevice( queue ) )
 		{
-			VkResult result = layer->_devFn.QueueWaitIdle( queue );
+			auto	layer = dev->Layer();
 
-			Call( layer->_fnTable.QueueWaitIdle, MakeTuple( queue ), result );
+			const uint64_t	entry_time	= layer->BeginCall();
+
+			VkResult result = dev->_devFn.QueueWaitIdle( queue );
+
+			if ( layer->IsStarted() )
+			{
+				CallEntryTime() = entry_time;
+				layer->_Call< Listener_QueueWaitIdle >( queue, result );
+			}
 
 			return result;
 		}
@@ -727,11 +1069,19 @@ namespace VSA
 	VKAPI_ATTR VkResult VKAPI_CALL LayerManager::vki_DeviceWaitIdle(
 		VkDevice                                    device)
 	{
-		if ( auto layer = Layer( device ) )
+		if ( auto dev = _FindDevice( device ) )
 		{
-			VkResult result = layer->_devFn.DeviceWaitIdle( device );
+			auto	layer = dev->Layer();
+
+			const uint64_t	entry_time	= layer->BeginCall();
+
+			VkResult result = dev->_devFn.DeviceWaitIdle( device );
 
-			Call( layer->_fnTable.DeviceWaitIdle, MakeTuple( device ), result );
+			if ( layer->IsStarted() )
+			{
+				CallEntryTime() = entry_time;
+				layer->_Call< Listener_DeviceWaitIdle >( device, result );
+			}
 
 			return result;
 		}
@@ -751,11 +1101,19 @@ namespace VSA
 		const VkBindSparseInfo*                     pBindInfo,
 		VkFence                                     fence)
 	{
-		if ( auto layer = Layer( queue ) )
+		if ( auto dev = _FindDevice( queue ) )
 		{
-			VkResult result = layer->_devFn.QueueBindSparse( queue, bindInfoCount, pBindInfo, fence );
+			auto	layer = dev->Layer();
+
+			const uint64_t	entry_time	= layer->BeginCall();
 
-			Call( layer->_fnTable.QueueBindSparse, MakeTuple( queue, bindInfoCount, pBindInfo, fence ), result );
+			VkResult result = dev->_devFn.QueueBindSparse( queue, bindInfoCount, pBindInfo, fence );
+
+			if ( layer->IsStarted() )
+			{
+				CallEntryTime() = entry_time;
+				layer->_Call< Listener_QueueBindSparse >( queue, bindInfoCount, pBindInfo, fence, result );
+			}
 
 			return result;
 		}
@@ -775,11 +1133,13 @@ namespace VSA
 		const VkAllocationCallbacks*                pAllocator,
 		VkFence*                                    pFence)
 	{
-		if ( auto layer = Layer( device ) )
+		if ( auto dev = _FindDevice( device ) )
 		{
-			VkResult result = layer->_devFn.CreateFence( device, pCreateInfo, pAllocator, OUT pFence );
+			auto	layer = dev->Layer();
 
-			Call( layer->_fnTable.CreateFence, MakeTuple( device, pCreateInfo, pAllocator, pFence ), result );
+			VkResult result = dev->_devFn.CreateFence( device, pCreateInfo, pAllocator, OUT pFence );
+
+			layer->_Call< Listener_CreateFence >( device, pCreateInfo, pAllocator, pFence, result );
 
 			return result;
 		}
@@ -798,11 +1158,17 @@ namespace VSA
 		VkFence                                     fence,
 		const VkAllocationCallbacks*                pAllocator)
 	{
-		if ( auto layer = Layer( device ) )
+		if ( auto dev = _FindDevice( device ) )
 		{
-			Call( layer->_fnTable.DestroyFence, MakeTuple( device, fence, pAllocator ));
+			auto	layer = dev->Layer();
+
+			if ( layer->IsStarted() )
+			{
+				CallEntryTime() = layer->BeginCall();
+				layer->_Call< Listener_DestroyFence >( device, fence, pAllocator );
+			}
 
-			return layer->_devFn.DestroyFence( device, fence, pAllocator );
+			return dev->_devFn.DestroyFence( device, fence, pAllocator );
 		}
 
 		CHECK( false );
@@ -818,11 +1184,19 @@ namespace VSA
 		uint32_t                                    fenceCount,
 		const VkFence*                              pFences)
 	{
-		if ( auto layer = Layer( device ) )
+		if ( auto dev = _FindDevice( device ) )
 		{
-			VkResult result = layer->_devFn.ResetFences( device, fenceCount, pFences );
+			auto	layer = dev->Layer();
+
+			const uint64_t	entry_time	= layer->BeginCall();
+
+			VkResult result = dev->_devFn.ResetFences( device, fenceCount, pFences );
 
-			Call( layer->_fnTable.ResetFences, MakeTuple( device, fenceCount, pFences ), result );
+			if ( layer->IsStarted() )
+			{
+				CallEntryTime() = entry_time;
+				layer->_Call< Listener_ResetFences >( device, fenceCount, pFences, result );
+			}
 
 			return result;
 		}
@@ -840,11 +1214,19 @@ namespace VSA
 		VkDevice                                    device,
 		VkFence                                     fence)
 	{
-		if ( auto layer = Layer( device ) )
+		if ( auto dev = _FindDevice( device ) )
 		{
-			VkResult result = layer->_devFn.GetFenceStatus( device, fence );
+			auto	layer = dev->Layer();
+
+			const uint64_t	entry_time	= layer->BeginCall();
 
-			Call( layer->_fnTable.GetFenceStatus, MakeTuple( device, fence ), result );
+			VkResult result = dev->_devFn.GetFenceStatus( device, fence );
+
+			if ( layer->IsStarted() )
+			{
+				CallEntryTime() = entry_time;
+				layer->_Call< Listener_GetFenceStatus >( device, fence, result );
+			}
 
 			return result;
 		}
@@ -865,11 +1247,22 @@ namespace VSA
 		VkBool32                                    waitAll,
 		uint64_t                                    timeout)
 	{
-		if ( auto layer = Layer( device ) )
+		if ( auto dev = _FindDevice( device ) )
 		{
-			VkResult result = layer->_devFn.WaitForFences( device, fenceCount, pFences, waitAll, timeout );
+			auto	layer = dev->Layer();
+
+			const uint64_t	entry_time	= layer->BeginCall();
+
+			VkResult result = dev->_devFn.WaitForFences( device, fenceCount, pFences, waitAll, timeout );
+
+			if ( layer->IsStarted() )
+			{
+				CallEntryTime() = entry_time;
+				layer->_Call< Listener_WaitForFences >( device, fenceCount, pFences, waitAll, timeout, result );
+			}
 
-			Call( layer->_fnTable.WaitForFences, MakeTuple( device, fenceCount, pFences, waitAll, timeout ), result );
+			if ( result == VK_SUCCESS )
+				layer->_OnWaitForFences( fenceCount, pFences, waitAll );
 
 			return result;
 		}
@@ -889,11 +1282,13 @@ namespace VSA
 		const VkAllocationCallbacks*                pAllocator,
 		VkSemaphore*                                pSemaphore)
 	{
-		if ( auto layer = Layer( device ) )
+		if ( auto dev = _FindDevice( device ) )
 		{
-			VkResult result = layer->_devFn.CreateSemaphore( device, pCreateInfo, pAllocator, OUT pSemaphore );
+			auto	layer = dev->Layer();
 
-			Call( layer->_fnTable.CreateSemaphore, MakeTuple( device, pCreateInfo, pAllocator, pSemaphore ), result );
+			VkResult result = dev->_devFn.CreateSemaphore( device, pCreateInfo, pAllocator, OUT pSemaphore );
+
+			layer->_Call< Listener_CreateSemaphore >( device, pCreateInfo, pAllocator, pSemaphore, result );
 
 			return result;
 		}
@@ -912,11 +1307,17 @@ namespace VSA
 		VkSemaphore                                 semaphore,
 		const VkAllocationCallbacks*                pAllocator)
 	{
-		if ( auto layer = Layer( device ) )
+		if ( auto dev = _FindDevice( device ) )
 		{
-			Call( layer->_fnTable.DestroySemaphore, MakeTuple( device, semaphore, pAllocator ));
+			auto	layer = dev->Layer();
+
+			if ( layer->IsStarted() )
+			{
+				CallEntryTime() = layer->BeginCall();
+				layer->_Call< Listener_DestroySemaphore >( device, semaphore, pAllocator );
+			}
 
-			return layer->_devFn.DestroySemaphore( device, semaphore, pAllocator );
+			return dev->_devFn.DestroySemaphore( device, semaphore, pAllocator );
 		}
 
 		CHECK( false );
@@ -933,11 +1334,13 @@ namespace VSA
 		const VkAllocationCallbacks*                pAllocator,
 		VkEvent*                                    pEvent)
 	{
-		if ( auto layer = Layer( device ) )
+		if ( auto dev = _FindDevice( device ) )
 		{
-			VkResult result = layer->_devFn.CreateEvent( device, pCreateInfo, pAllocator, OUT pEvent );
+			auto	layer = dev->Layer();
+
+			VkResult result = dev->_devFn.CreateEvent( device, pCreateInfo, pAllocator, OUT pEvent );
 
-			Call( layer->_fnTable.CreateEvent, MakeTuple( device, pCreateInfo, pAllocator, pEvent ), result );
+			layer->_Call< Listener_CreateEvent >( device, pCreateInfo, pAllocator, pEvent, result );
 
 			return result;
 		}
@@ -956,11 +1359,13 @@ namespace VSA
 		VkEvent                                     event,
 		const VkAllocationCallbacks*                pAllocator)
 	{
-		if ( auto layer = Layer( device ) )
+		if ( auto dev = _FindDevice( device ) )
 		{
-			Call( layer->_fnTable.DestroyEvent, MakeTuple( device, event, pAllocator ));
+			auto	layer = dev->Layer();
+
+			layer->_Call< Listener_DestroyEvent >( device, event, pAllocator );
 
-			return layer->_devFn.DestroyEvent( device, event, pAllocator );
+			return dev->_devFn.DestroyEvent( device, event, pAllocator );
 		}
 
 		CHECK( false );
@@ -975,11 +1380,13 @@ namespace VSA
 		VkDevice                                    device,
 		VkEvent                                     event)
 	{
-		if ( auto layer = Layer( device ) )
+		if ( auto dev = _FindDevice( device ) )
 		{
-			VkResult result = layer->_devFn.SetEvent( device, event );
+			auto	layer = dev->Layer();
 
-			Call( layer->_fnTable.SetEvent, MakeTuple( device, event ), result );
+			VkResult result = dev->_devFn.SetEvent( device, event );
+
+			layer->_Call< Listener_SetEvent >( device, event, result );
 
 			return result;
 		}
@@ -997,11 +1404,13 @@ namespace VSA
 		VkDevice                                    device,
 		VkEvent                                     event)
 	{
-		if ( auto layer = Layer( device ) )
+		if ( auto dev = _FindDevice( device ) )
 		{
-			VkResult result = layer->_devFn.ResetEvent( device, event );
+			auto	layer = dev->Layer();
+
+			VkResult result = dev->_devFn.ResetEvent( device, event );
 
-			Call( layer->_fnTable.ResetEvent, MakeTuple( device, event ), result );
+			layer->_Call< Listener_ResetEvent >( device, event, result );
 
 			return result;
 		}
@@ -1021,11 +1430,13 @@ namespace VSA
 		const VkAllocationCallbacks*                pAllocator,
 		VkCommandPool*                              pCommandPool)
 	{
-		if ( auto layer = Layer( device ) )
+		if ( auto dev = _FindDevice( device ) )
 		{
-			VkResult result = layer->_devFn.CreateCommandPool( device, pCreateInfo, pAllocator, OUT pCommandPool );
+			auto	layer = dev->Layer();
+
+			VkResult result = dev->_devFn.CreateCommandPool( device, pCreateInfo, pAllocator, OUT pCommandPool );
 
-			Call( layer->_fnTable.CreateCommandPool, MakeTuple( device, pCreateInfo, pAllocator, pCommandPool ), result );
+			layer->_Call< Listener_CreateCommandPool >( device, pCreateInfo, pAllocator, pCommandPool, result );
 
 			return result;
 		}
@@ -1044,11 +1455,13 @@ namespace VSA
 		VkCommandPool                               commandPool,
 		const VkAllocationCallbacks*                pAllocator)
 	{
-		if ( auto layer = Layer( device ) )
+		if ( auto dev = _FindDevice( device ) )
 		{
-			Call( layer->_fnTable.DestroyCommandPool, MakeTuple( device, commandPool, pAllocator ));
+			auto	layer = dev->Layer();
 
-			return layer->_devFn.DestroyCommandPool( device, commandPool, pAllocator );
+			layer->_Call< Listener_DestroyCommandPool >( device, commandPool, pAllocator );
+
+			return dev->_devFn.DestroyCommandPool( device, commandPool, pAllocator );
 		}
 
 		CHECK( false );
@@ -1064,11 +1477,13 @@ namespace VSA
 		VkCommandPool                               commandPool,
 		VkCommandPoolResetFlags                     flags)
 	{
-		if ( auto layer = Layer( device ) )
+		if ( auto dev = _FindDevice( device ) )
 		{
-			VkResult result = layer->_devFn.ResetCommandPool( device, commandPool, flags );
+			auto	layer = dev->Layer();
+
+			VkResult result = dev->_devFn.ResetCommandPool( device, commandPool, flags );
 
-			Call( layer->_fnTable.ResetCommandPool, MakeTuple( device, commandPool, flags ), result );
+			layer->_Call< Listener_ResetCommandPool >( device, commandPool, flags, result );
 
 			return result;
 		}
@@ -1087,21 +1502,13 @@ namespace VSA
 		const VkCommandBufferAllocateInfo*          pAllocateInfo,
 		VkCommandBuffer*                            pCommandBuffers)
 	{
-		if ( auto layer = Layer( device ) )
+		if ( auto dev = _FindDevice( device ) )
 		{
-			VkResult result = layer->_devFn.AllocateCommandBuffers( device, pAllocateInfo, OUT pCommandBuffers );
-
-			if ( result == VK_SUCCESS and pCommandBuffers )
-			{
-				auto&	inst = Instance();
-				EXLOCK( inst._lock );
+			auto	layer = dev->Layer();
 
-				for (uint i = 0; i < pAllocateInfo->commandBufferCount; ++i) {
-					inst._cmdBufferToLayer.insert_or_assign( pCommandBuffers[i], layer );
-				}
-			}
+			VkResult result = dev->_devFn.AllocateCommandBuffers( device, pAllocateInfo, OUT pCommandBuffers );
 
-			Call( layer->_fnTable.AllocateCommandBuffers, MakeTuple( device, pAllocateInfo, pCommandBuffers ), result );
+			layer->_Call< Listener_AllocateCommandBuffers >( device, pAllocateInfo, pCommandBuffers, result );
 
 			return result;
 		}
@@ -1121,18 +1528,13 @@ namespace VSA
 		uint32_t                                    commandBufferCount,
 		const VkCommandBuffer*                      pCommandBuffers)
 	{
-		if ( auto layer = Layer( device ) )
+		if ( auto dev = _FindDevice( device ) )
 		{
-			layer->_devFn.FreeCommandBuffers( device, commandPool, commandBufferCount, pCommandBuffers );
-			
-			auto&	inst = Instance();
-			EXLOCK( inst._lock );
+			auto	layer = dev->Layer();
 
-			for (uint i = 0; i < commandBufferCount; ++i) {
-				inst._cmdBufferToLayer.erase( pCommandBuffers[i] );
-			}
+			dev->_devFn.FreeCommandBuffers( device, commandPool, commandBufferCount, pCommandBuffers );
 
-			Call( layer->_fnTable.FreeCommandBuffers, MakeTuple( device, commandPool, commandBufferCount, pCommandBuffers ));
+			layer->_Call< Listener_FreeCommandBuffers >( device, commandPool, commandBufferCount, pCommandBuffers );
 			return;
 		}
 
@@ -1148,11 +1550,13 @@ namespace VSA
 		VkCommandBuffer                             commandBuffer,
 		const VkCommandBufferBeginInfo*             pBeginInfo)
 	{
-		if ( auto layer = Layer( commandBuffer ) )
+		if ( auto dev = _FindDevice( commandBuffer ) )
 		{
-			VkResult result = layer->_devFn.BeginCommandBuffer( commandBuffer, pBeginInfo );
+			auto	layer = dev->Layer();
+
+			VkResult result = dev->_devFn.BeginCommandBuffer( commandBuffer, pBeginInfo );
 
-			Call( layer->_fnTable.BeginCommandBuffer, MakeTuple( commandBuffer, pBeginInfo ), result );
+			layer->_Call< Listener_BeginCommandBuffer >( commandBuffer, pBeginInfo, result );
 
 			return result;
 		}
@@ -1169,11 +1573,13 @@ namespace VSA
 	VKAPI_ATTR VkResult VKAPI_CALL LayerManager::vki_EndCommandBuffer(
 		VkCommandBuffer                             commandBuffer)
 	{
-		if ( auto layer = Layer( commandBuffer ) )
+		if ( auto dev = _FindDevice( commandBuffer ) )
 		{
-			Call( layer->_fnTable.EndCommandBuffer, MakeTuple( commandBuffer ), VK_SUCCESS );	// TODO ?
+			auto	layer = dev->Layer();
 
-			return layer->_devFn.EndCommandBuffer( commandBuffer );
+			layer->_Call< Listener_EndCommandBuffer >( commandBuffer, VK_SUCCESS );	// TODO ?
+
+			return dev->_devFn.EndCommandBuffer( commandBuffer );
 		}
 
 		CHECK( false );
@@ -1189,11 +1595,13 @@ namespace VSA
 		VkCommandBuffer                             commandBuffer,
 		VkCommandBufferResetFlags                   flags)
 	{
-		if ( auto layer = Layer( commandBuffer ) )
+		if ( auto dev = _FindDevice( commandBuffer ) )
 		{
-			VkResult result = layer->_devFn.ResetCommandBuffer( commandBuffer, flags );
+			auto	layer = dev->Layer();
+
+			VkResult result = dev->_devFn.ResetCommandBuffer( commandBuffer, flags );
 
-			Call( layer->_fnTable.ResetCommandBuffer, MakeTuple( commandBuffer, flags ), result );
+			layer->_Call< Listener_ResetCommandBuffer >( commandBuffer, flags, result );
 
 			return result;
 		}
@@ -1212,11 +1620,13 @@ namespace VSA
 		VkEvent                                     event,
 		VkPipelineStageFlags                        stageMask)
 	{
-		if ( auto layer = Layer( commandBuffer ) )
+		if ( auto dev = _FindDevice( commandBuffer ) )
 		{
-			layer->_devFn.CmdSetEvent( commandBuffer, event, stageMask );
+			auto	layer = dev->Layer();
+
+			dev->_devFn.CmdSetEvent( commandBuffer, event, stageMask );
 
-			Call( layer->_fnTable.CmdSetEvent, MakeTuple( commandBuffer, event, stageMask ));
+			layer->_Call< Listener_CmdSetEvent >( commandBuffer, event, stageMask );
 			return;
 		}
 
@@ -1233,11 +1643,13 @@ namespace VSA
 		VkEvent                                     event,
 		VkPipelineStageFlags                        stageMask)
 	{
-		if ( auto layer = Layer( commandBuffer ) )
+		if ( auto dev = _FindDevice( commandBuffer ) )
 		{
-			layer->_devFn.CmdResetEvent( commandBuffer, event, stageMask );
+			auto	layer = dev->Layer();
 
-			Call( layer->_fnTable.CmdResetEvent, MakeTuple( commandBuffer, event, stageMask ));
+			dev->_devFn.CmdResetEvent( commandBuffer, event, stageMask );
+
+			layer->_Call< Listener_CmdResetEvent >( commandBuffer, event, stageMask );
 			return;
 		}
 
@@ -1262,22 +1674,23 @@ namespace VSA
 		uint32_t                                    imageMemoryBarrierCount,
 		const VkImageMemoryBarrier*                 pImageMemoryBarriers)
 	{
-		if ( auto layer = Layer( commandBuffer ) )
+		if ( auto dev = _FindDevice( commandBuffer ) )
 		{
-			layer->_devFn.CmdWaitEvents( commandBuffer,
+			auto	layer = dev->Layer();
+
+			dev->_devFn.CmdWaitEvents( commandBuffer,
 										 eventCount, pEvents,
 										 srcStageMask, dstStageMask,
 										 memoryBarrierCount, pMemoryBarriers,
 										 bufferMemoryBarrierCount, pBufferMemoryBarriers,
 										 imageMemoryBarrierCount, pImageMemoryBarriers );
 
-			Call( layer->_fnTable.CmdWaitEvents,
-				  MakeTuple( commandBuffer,
-							 eventCount, pEvents,
-							 srcStageMask, dstStageMask,
-							 memoryBarrierCount, pMemoryBarriers,
-							 bufferMemoryBarrierCount, pBufferMemoryBarriers,
-							 imageMemoryBarrierCount, pImageMemoryBarriers ));
+			layer->_Call< Listener_CmdWaitEvents >( commandBuffer,
+													eventCount, pEvents,
+													srcStageMask, dstStageMask,
+													memoryBarrierCount, pMemoryBarriers,
+													bufferMemoryBarrierCount, pBufferMemoryBarriers,
+													imageMemoryBarrierCount, pImageMemoryBarriers );
 			return;
 		}
 
@@ -1301,20 +1714,21 @@ namespace VSA
 		uint32_t                                    imageMemoryBarrierCount,
 		const VkImageMemoryBarrier*                 pImageMemoryBarriers)
 	{
-		if ( auto layer = Layer( commandBuffer ) )
+		if ( auto dev = _FindDevice( commandBuffer ) )
 		{
-			layer->_devFn.CmdPipelineBarrier( commandBuffer,
-											  srcStageMask, dstStageMask, dependencyFlags,
-											  memoryBarrierCount, pMemoryBarriers,
-											  bufferMemoryBarrierCount, pBufferMemoryBarriers,
-											  imageMemoryBarrierCount, pImageMemoryBarriers );
+			auto	layer = dev->Layer();
+
+			dev->_devFn.CmdPipelineBarrier( commandBuffer,
+											srcStageMask, dstStageMask, dependencyFlags,
+											memoryBarrierCount, pMemoryBarriers,
+											bufferMemoryBarrierCount, pBufferMemoryBarriers,
+											imageMemoryBarrierCount, pImageMemoryBarriers );
 
-			Call( layer->_fnTable.CmdPipelineBarrier,
-				  MakeTuple( commandBuffer,
-							 srcStageMask, dstStageMask, dependencyFlags,
-							 memoryBarrierCount, pMemoryBarriers,
-							 bufferMemoryBarrierCount, pBufferMemoryBarriers,
-							 imageMemoryBarrierCount, pImageMemoryBarriers ));
+			layer->_Call< Listener_CmdPipelineBarrier >( commandBuffer,
+														 srcStageMask, dstStageMask, dependencyFlags,
+														 memoryBarrierCount, pMemoryBarriers,
+														 bufferMemoryBarrierCount, pBufferMemoryBarriers,
+														 imageMemoryBarrierCount, pImageMemoryBarriers );
 			return;
 		}
 
@@ -1331,11 +1745,13 @@ namespace VSA
 		const VkRenderPassBeginInfo*                pRenderPassBegin,
 		VkSubpassContents                           contents)
 	{
-		if ( auto layer = Layer( commandBuffer ) )
+		if ( auto dev = _FindDevice( commandBuffer ) )
 		{
-			layer->_devFn.CmdBeginRenderPass( commandBuffer, pRenderPassBegin, contents );
+			auto	layer = dev->Layer();
 
-			Call( layer->_fnTable.CmdBeginRenderPass, MakeTuple( commandBuffer, pRenderPassBegin, contents ));
+			dev->_devFn.CmdBeginRenderPass( commandBuffer, pRenderPassBegin, contents );
+
+			layer->_Call< Listener_CmdBeginRenderPass >( commandBuffer, pRenderPassBegin, contents );
 			return;
 		}
 
@@ -1351,11 +1767,13 @@ namespace VSA
 		VkCommandBuffer                             commandBuffer,
 		VkSubpassContents                           contents)
 	{
-		if ( auto layer = Layer( commandBuffer ) )
+		if ( auto dev = _FindDevice( commandBuffer ) )
 		{
-			layer->_devFn.CmdNextSubpass( commandBuffer, contents );
+			auto	layer = dev->Layer();
+
+			dev->_devFn.CmdNextSubpass( commandBuffer, contents );
 
-			Call( layer->_fnTable.CmdNextSubpass, MakeTuple( commandBuffer, contents ));
+			layer->_Call< Listener_CmdNextSubpass >( commandBuffer, contents );
 			return;
 		}
 
@@ -1370,11 +1788,13 @@ namespace VSA
 	VKAPI_ATTR void VKAPI_CALL LayerManager::vki_CmdEndRenderPass(
 		VkCommandBuffer                             commandBuffer)
 	{
-		if ( auto layer = Layer( commandBuffer ) )
+		if ( auto dev = _FindDevice( commandBuffer ) )
 		{
-			Call( layer->_fnTable.CmdEndRenderPass, MakeTuple( commandBuffer ));
+			auto	layer = dev->Layer();
+
+			layer->_Call< Listener_CmdEndRenderPass >( commandBuffer );
 
-			return layer->_devFn.CmdEndRenderPass( commandBuffer );
+			return dev->_devFn.CmdEndRenderPass( commandBuffer );
 		}
 
 		CHECK( false );
@@ -1390,11 +1810,13 @@ namespace VSA
 		uint32_t                                    commandBufferCount,
 		const VkCommandBuffer*                      pCommandBuffers)
 	{
-		if ( auto layer = Layer( commandBuffer ) )
+		if ( auto dev = _FindDevice( commandBuffer ) )
 		{
-			layer->_devFn.CmdExecuteCommands( commandBuffer, commandBufferCount, pCommandBuffers );
+			auto	layer = dev->Layer();
 
-			Call( layer->_fnTable.CmdExecuteCommands, MakeTuple( commandBuffer, commandBufferCount, pCommandBuffers ));
+			dev->_devFn.CmdExecuteCommands( commandBuffer, commandBufferCount, pCommandBuffers );
+
+			layer->_Call< Listener_CmdExecuteCommands >( commandBuffer, commandBufferCount, pCommandBuffers );
 			return;
 		}
 
@@ -1411,11 +1833,13 @@ namespace VSA
 		VkCommandPool                               commandPool,
 		VkCommandPoolTrimFlags                      flags)
 	{
-		if ( auto layer = Layer( device ) )
+		if ( auto dev = _FindDevice( device ) )
 		{
-			layer->_devFn.TrimCommandPool( device, commandPool, flags );
+			auto	layer = dev->Layer();
+
+			dev->_devFn.TrimCommandPool( device, commandPool, flags );
 
-			Call( layer->_fnTable.TrimCommandPool, MakeTuple( device, commandPool, flags ));
+			layer->_Call< Listener_TrimCommandPool >( device, commandPool, flags );
 			return;
 		}
 
@@ -1432,18 +1856,13 @@ namespace VSA
 		const VkDeviceQueueInfo2*                   pQueueInfo,
 		VkQueue*                                    pQueue)
 	{
-		if ( auto layer = Layer( device ) )
+		if ( auto dev = _FindDevice( device ) )
 		{
-			layer->_devFn.GetDeviceQueue2( device, pQueueInfo, OUT pQueue );
+			auto	layer = dev->Layer();
 
-			if ( pQueue and *pQueue )
-			{
-				auto&	inst = Instance();
-				EXLOCK( inst._lock );
-				inst._queueToLayer.insert_or_assign( *pQueue, layer );
-			}
+			dev->_devFn.GetDeviceQueue2( device, pQueueInfo, OUT pQueue );
 
-			Call( layer->_fnTable.GetDeviceQueue2, MakeTuple( device, pQueueInfo, pQueue ));
+			layer->_Call< Listener_GetDeviceQueue2 >( device, pQueueInfo, pQueue );
 			return;
 		}
 
@@ -1461,14 +1880,16 @@ namespace VSA
 		const VkAllocationCallbacks*                pAllocator,
 		VkSwapchainKHR*                             pSwapchain)
 	{
-		if ( auto layer = Layer( device ) )
+		if ( auto dev = _FindDevice( device ) )
 		{
+			auto	layer = dev->Layer();
+
 			VkResult result = VK_RESULT_MAX_ENUM;
 			
-			if ( layer->_devFn.CreateSwapchainKHR )
-				result = layer->_devFn.CreateSwapchainKHR( device, pCreateInfo, pAllocator, OUT pSwapchain );
+			if ( dev->_devFn.CreateSwapchainKHR )
+				result = dev->_devFn.CreateSwapchainKHR( device, pCreateInfo, pAllocator, OUT pSwapchain );
 
-			Call( layer->_fnTable.CreateSwapchainKHR, MakeTuple( device, pCreateInfo, pAllocator, pSwapchain ), result );
+			layer->_Call< Listener_CreateSwapchainKHR >( device, pCreateInfo, pAllocator, pSwapchain, result );
 
 			return result;
 		}
@@ -1487,12 +1908,18 @@ namespace VSA
 		VkSwapchainKHR                              swapchain,
 		const VkAllocationCallbacks*                pAllocator)
 	{
-		if ( auto layer = Layer( device ) )
+		if ( auto dev = _FindDevice( device ) )
 		{
-			Call( layer->_fnTable.DestroySwapchainKHR, MakeTuple( device, swapchain, pAllocator ));
+			auto	layer = dev->Layer();
+
+			if ( layer->IsStarted() )
+			{
+				CallEntryTime() = layer->BeginCall();
+				layer->_Call< Listener_DestroySwapchainKHR >( device, swapchain, pAllocator );
+			}
 
-			if ( layer->_devFn.DestroySwapchainKHR )
-				layer->_devFn.DestroySwapchainKHR( device, swapchain, pAllocator );
+			if ( dev->_devFn.DestroySwapchainKHR )
+				dev->_devFn.DestroySwapchainKHR( device, swapchain, pAllocator );
 
 			return;
 		}
@@ -1513,15 +1940,22 @@ namespace VSA
 		VkFence                                     fence,
 		uint32_t*                                   pImageIndex)
 	{
-		if ( auto layer = Layer( device ) )
+		if ( auto dev = _FindDevice( device ) )
 		{
+			auto	layer = dev->Layer();
+
+			const uint64_t	entry_time	= layer->BeginCall();
+
 			VkResult result = VK_RESULT_MAX_ENUM;
 			
-			if ( layer->_devFn.AcquireNextImageKHR )
-				result = layer->_devFn.AcquireNextImageKHR( device, swapchain, timeout, semaphore, fence, OUT pImageIndex );
+			if ( dev->_devFn.AcquireNextImageKHR )
+				result = dev->_devFn.AcquireNextImageKHR( device, swapchain, timeout, semaphore, fence, OUT pImageIndex );
 
-			Call( layer->_fnTable.AcquireNextImageKHR,
-				  MakeTuple( device, swapchain, timeout, semaphore, fence, pImageIndex ), result );
+			if ( layer->IsStarted() )
+			{
+				CallEntryTime() = entry_time;
+				layer->_Call< Listener_AcquireNextImageKHR >( device, swapchain, timeout, semaphore, fence, pImageIndex, result );
+			}
 
 			return result;
 		}
@@ -1540,15 +1974,22 @@ namespace VSA
 		const VkAcquireNextImageInfoKHR*            pAcquireInfo,
 		uint32_t*                                   pImageIndex)
 	{
-		if ( auto layer = Layer( device ) )
+		if ( auto dev = _FindDevice( device ) )
 		{
+			auto	layer = dev->Layer();
+
+			const uint64_t	entry_time	= layer->BeginCall();
+
 			VkResult result = VK_RESULT_MAX_ENUM;
 			
-			if ( layer->_devFn.AcquireNextImage2KHR )
-				result = layer->_devFn.AcquireNextImage2KHR( device, pAcquireInfo, OUT pImageIndex );
+			if ( dev->_devFn.AcquireNextImage2KHR )
+				result = dev->_devFn.AcquireNextImage2KHR( device, pAcquireInfo, OUT pImageIndex );
 
-			Call( layer->_fnTable.AcquireNextImage2KHR,
-				  MakeTuple( device, pAcquireInfo, pImageIndex ), result );
+			if ( layer->IsStarted() )
+			{
+				CallEntryTime() = entry_time;
+				layer->_Call< Listener_AcquireNextImage2KHR >( device, pAcquireInfo, pImageIndex, result );
+			}
 
 			return result;
 		}
@@ -1566,15 +2007,23 @@ namespace VSA
 		VkQueue                                     queue,
 		const VkPresentInfoKHR*                     pPresentInfo)
 	{
-		if ( auto layer = Layer( queue ) )
+		if ( auto dev = _FindDevice( queue ) )
 		{
+			auto	layer = dev->Layer();
+
+			const uint64_t	entry_time	= layer->BeginCall();
+
 			VkResult result = VK_RESULT_MAX_ENUM;
 			
-			if ( layer->_devFn.QueuePresentKHR )
-				result = layer->_devFn.QueuePresentKHR( queue, pPresentInfo );
+			if ( dev->_devFn.QueuePresentKHR )
+				result = dev->_devFn.QueuePresentKHR( queue, pPresentInfo );
 
-			Call( layer->_fnTable.QueuePresentKHR, MakeTuple( queue, pPresentInfo ), result );
-			layer->_Update();
+			if ( layer->IsStarted() )
+			{
+				CallEntryTime() = entry_time;
+				layer->_Call< Listener_QueuePresentKHR >( queue, pPresentInfo, result );
+			}
+			layer->_EndFrame();
 
 			return result;
 		}
@@ -1593,13 +2042,14 @@ namespace VSA
 		const VkRenderPassBeginInfo*                pRenderPassBegin,
 		const VkSubpassBeginInfoKHR*                pSubpassBeginInfo)
 	{
-		if ( auto layer = Layer( commandBuffer ) )
+		if ( auto dev = _FindDevice( commandBuffer ) )
 		{
-			if ( layer->_devFn.CmdBeginRenderPass2KHR )
-				layer->_devFn.CmdBeginRenderPass2KHR( commandBuffer, pRenderPassBegin, pSubpassBeginInfo );
+			auto	layer = dev->Layer();
+
+			if ( dev->_devFn.CmdBeginRenderPass2KHR )
+				dev->_devFn.CmdBeginRenderPass2KHR( commandBuffer, pRenderPassBegin, pSubpassBeginInfo );
 
-			Call( layer->_fnTable.CmdBeginRenderPass2KHR,
-				  MakeTuple( commandBuffer, pRenderPassBegin, pSubpassBeginInfo ));
+			layer->_Call< Listener_CmdBeginRenderPass2KHR >( commandBuffer, pRenderPassBegin, pSubpassBeginInfo );
 			return;
 		}
 
@@ -1616,13 +2066,14 @@ namespace VSA
 		const VkSubpassBeginInfoKHR*                pSubpassBeginInfo,
 		const VkSubpassEndInfoKHR*                  pSubpassEndInfo)
 	{
-		if ( auto layer = Layer( commandBuffer ) )
+		if ( auto dev = _FindDevice( commandBuffer ) )
 		{
-			if ( layer->_devFn.CmdNextSubpass2KHR )
-				layer->_devFn.CmdNextSubpass2KHR( commandBuffer, pSubpassBeginInfo, pSubpassEndInfo );
+			auto	layer = dev->Layer();
 
-			Call( layer->_fnTable.CmdNextSubpass2KHR,
-				  MakeTuple( commandBuffer, pSubpassBeginInfo, pSubpassEndInfo ));
+			if ( dev->_devFn.CmdNextSubpass2KHR )
+				dev->_devFn.CmdNextSubpass2KHR( commandBuffer, pSubpassBeginInfo, pSubpassEndInfo );
+
+			layer->_Call< Listener_CmdNextSubpass2KHR >( commandBuffer, pSubpassBeginInfo, pSubpassEndInfo );
 			return;
 		}
 
@@ -1638,12 +2089,14 @@ namespace VSA
 		VkCommandBuffer                             commandBuffer,
 		const VkSubpassEndInfoKHR*                  pSubpassEndInfo)
 	{
-		if ( auto layer = Layer( commandBuffer ) )
+		if ( auto dev = _FindDevice( commandBuffer ) )
 		{
-			Call( layer->_fnTable.CmdEndRenderPass2KHR, MakeTuple( commandBuffer, pSubpassEndInfo ));
+			auto	layer = dev->Layer();
+
+			layer->_Call< Listener_CmdEndRenderPass2KHR >( commandBuffer, pSubpassEndInfo );
 
-			if ( layer->_devFn.CmdEndRenderPass2KHR )
-				layer->_devFn.CmdEndRenderPass2KHR( commandBuffer, pSubpassEndInfo );
+			if ( dev->_devFn.CmdEndRenderPass2KHR )
+				dev->_devFn.CmdEndRenderPass2KHR( commandBuffer, pSubpassEndInfo );
 
 			return;
 		}
@@ -1660,14 +2113,16 @@ namespace VSA
 		VkDevice                                    device,
 		const VkDebugMarkerObjectTagInfoEXT*        pTagInfo)
 	{
-		if ( auto layer = Layer( device ) )
+		if ( auto dev = _FindDevice( device ) )
 		{
+			auto	layer = dev->Layer();
+
 			VkResult result = VK_SUCCESS;
 
-			if ( layer->_devFn.DebugMarkerSetObjectTagEXT )
-				result = layer->_devFn.DebugMarkerSetObjectTagEXT( device, pTagInfo );
+			if ( dev->_devFn.DebugMarkerSetObjectTagEXT )
+				result = dev->_devFn.DebugMarkerSetObjectTagEXT( device, pTagInfo );
 			
-			Call( layer->_fnTable.DebugMarkerSetObjectTagEXT, MakeTuple( device, pTagInfo ), result );
+			layer->_Call< Listener_DebugMarkerSetObjectTagEXT >( device, pTagInfo, result );
 
 			return result;
 		}
@@ -1685,14 +2140,19 @@ namespace VSA
 		VkDevice                                    device,
 		const VkDebugMarkerObjectNameInfoEXT*       pNameInfo)
 	{
-		if ( auto layer = Layer( device ) )
+		if ( auto dev = _FindDevice( device ) )
 		{
+			auto	layer = dev->Layer();
+
 			VkResult result = VK_SUCCESS;
 
-			if ( layer->_devFn.DebugMarkerSetObjectNameEXT )
-				result = layer->_devFn.DebugMarkerSetObjectNameEXT( device, pNameInfo );
+			if ( dev->_devFn.DebugMarkerSetObjectNameEXT )
+				result = dev->_devFn.DebugMarkerSetObjectNameEXT( device, pNameInfo );
 			
-			Call( layer->_fnTable.DebugMarkerSetObjectNameEXT, MakeTuple( device, pNameInfo ), result );
+			layer->_Call< Listener_DebugMarkerSetObjectNameEXT >( device, pNameInfo, result );
+
+			if ( pNameInfo and pNameInfo->objectType == VK_DEBUG_REPORT_OBJECT_TYPE_FENCE_EXT )
+				layer->_OnSetFenceName( pNameInfo->object, pNameInfo->pObjectName );
 
 			return result;
 		}
@@ -1710,12 +2170,14 @@ namespace VSA
 		VkCommandBuffer                             commandBuffer,
 		const VkDebugMarkerMarkerInfoEXT*           pMarkerInfo)
 	{
-		if ( auto layer = Layer( commandBuffer ) )
+		if ( auto dev = _FindDevice( commandBuffer ) )
 		{
-			if ( layer->_devFn.CmdDebugMarkerBeginEXT )
-				layer->_devFn.CmdDebugMarkerBeginEXT( commandBuffer, pMarkerInfo );
+			auto	layer = dev->Layer();
+
+			if ( dev->_devFn.CmdDebugMarkerBeginEXT )
+				dev->_devFn.CmdDebugMarkerBeginEXT( commandBuffer, pMarkerInfo );
 
-			Call( layer->_fnTable.CmdDebugMarkerBeginEXT, MakeTuple( commandBuffer, pMarkerInfo ));
+			layer->_Call< Listener_CmdDebugMarkerBeginEXT >( commandBuffer, pMarkerInfo );
 			return;
 		}
 
@@ -1730,12 +2192,14 @@ namespace VSA
 	VKAPI_ATTR void VKAPI_CALL LayerManager::vki_CmdDebugMarkerEndEXT(
 		VkCommandBuffer                             commandBuffer)
 	{
-		if ( auto layer = Layer( commandBuffer ) )
+		if ( auto dev = _FindDevice( commandBuffer ) )
 		{
-			Call( layer->_fnTable.CmdDebugMarkerEndEXT, MakeTuple( commandBuffer ));
+			auto	layer = dev->Layer();
 
-			if ( layer->_devFn.CmdDebugMarkerEndEXT )
-				layer->_devFn.CmdDebugMarkerEndEXT( commandBuffer );
+			layer->_Call< Listener_CmdDebugMarkerEndEXT >( commandBuffer );
+
+			if ( dev->_devFn.CmdDebugMarkerEndEXT )
+				dev->_devFn.CmdDebugMarkerEndEXT( commandBuffer );
 
 			return;
 		}
@@ -1752,12 +2216,14 @@ namespace VSA
 		VkCommandBuffer                             commandBuffer,
 		const VkDebugMarkerMarkerInfoEXT*           pMarkerInfo)
 	{
-		if ( auto layer = Layer( commandBuffer ) )
+		if ( auto dev = _FindDevice( commandBuffer ) )
 		{
-			if ( layer->_devFn.CmdDebugMarkerInsertEXT )
-				layer->_devFn.CmdDebugMarkerInsertEXT( commandBuffer, pMarkerInfo );
+			auto	layer = dev->Layer();
+
+			if ( dev->_devFn.CmdDebugMarkerInsertEXT )
+				dev->_devFn.CmdDebugMarkerInsertEXT( commandBuffer, pMarkerInfo );
 
-			Call( layer->_fnTable.CmdDebugMarkerInsertEXT, MakeTuple( commandBuffer, pMarkerInfo ));
+			layer->_Call< Listener_CmdDebugMarkerInsertEXT >( commandBuffer, pMarkerInfo );
 			return;
 		}
 
@@ -1773,14 +2239,19 @@ namespace VSA
 		VkDevice                                    device,
 		const VkDebugUtilsObjectNameInfoEXT*        pNameInfo)
 	{
-		if ( auto layer = Layer( device ) )
+		if ( auto dev = _FindDevice( device ) )
 		{
+			auto	layer = dev->Layer();
+
 			VkResult result = VK_SUCCESS;
 				
-			if ( layer->_devFn.SetDebugUtilsObjectNameEXT )
-				result = layer->_devFn.SetDebugUtilsObjectNameEXT( device, pNameInfo );
+			if ( dev->_devFn.SetDebugUtilsObjectNameEXT )
+				result = dev->_devFn.SetDebugUtilsObjectNameEXT( device, pNameInfo );
 
-			Call( layer->_fnTable.SetDebugUtilsObjectNameEXT, MakeTuple( device, pNameInfo ), result );
+			layer->_Call< Listener_SetDebugUtilsObjectNameEXT >( device, pNameInfo, result );
+
+			if ( pNameInfo and pNameInfo->objectType == VK_OBJECT_TYPE_FENCE )
+				layer->_OnSetFenceName( pNameInfo->objectHandle, pNameInfo->pObjectName );
 
 			return result;
 		}
@@ -1798,14 +2269,16 @@ namespace VSA
 		VkDevice                                    device,
 		const VkDebugUtilsObjectTagInfoEXT*         pTagInfo)
 	{
-		if ( auto layer = Layer( device ) )
+		if ( auto dev = _FindDevice( device ) )
 		{
+			auto	layer = dev->Layer();
+
 			VkResult result = VK_SUCCESS;
 
-			if ( layer->_devFn.SetDebugUtilsObjectTagEXT )
-				result = layer->_devFn.SetDebugUtilsObjectTagEXT( device, pTagInfo );
+			if ( dev->_devFn.SetDebugUtilsObjectTagEXT )
+				result = dev->_devFn.SetDebugUtilsObjectTagEXT( device, pTagInfo );
 
-			Call( layer->_fnTable.SetDebugUtilsObjectTagEXT, MakeTuple( device, pTagInfo ), result );
+			layer->_Call< Listener_SetDebugUtilsObjectTagEXT >( device, pTagInfo, result );
 
 			return result;
 		}
@@ -1823,12 +2296,14 @@ namespace VSA
 		VkQueue                                     queue,
 		const VkDebugUtilsLabelEXT*                 pLabelInfo)
 	{
-		if ( auto layer = Layer( queue ) )
+		if ( auto dev = _FindDevice( queue ) )
 		{
-			if ( layer->_devFn.QueueBeginDebugUtilsLabelEXT )
-				layer->_devFn.QueueBeginDebugUtilsLabelEXT( queue, pLabelInfo );
+			auto	layer = dev->Layer();
+
+			if ( dev->_devFn.QueueBeginDebugUtilsLabelEXT )
+				dev->_devFn.QueueBeginDebugUtilsLabelEXT( queue, pLabelInfo );
 
-			Call( layer->_fnTable.QueueBeginDebugUtilsLabelEXT, MakeTuple( queue, pLabelInfo ));
+			layer->_Call< Listener_QueueBeginDebugUtilsLabelEXT >( queue, pLabelInfo );
 			return;
 		}
 
@@ -1843,12 +2318,14 @@ namespace VSA
 	VKAPI_ATTR void VKAPI_CALL LayerManager::vki_QueueEndDebugUtilsLabelEXT(
 		VkQueue                                     queue)
 	{
-		if ( auto layer = Layer( queue ) )
+		if ( auto dev = _FindDevice( queue ) )
 		{
-			Call( layer->_fnTable.QueueEndDebugUtilsLabelEXT, MakeTuple( queue ));
+			auto	layer = dev->Layer();
 
-			if ( layer->_devFn.QueueEndDebugUtilsLabelEXT )
-				layer->_devFn.QueueEndDebugUtilsLabelEXT( queue );
+			layer->_Call< Listener_QueueEndDebugUtilsLabelEXT >( queue );
+
+			if ( dev->_devFn.QueueEndDebugUtilsLabelEXT )
+				dev->_devFn.QueueEndDebugUtilsLabelEXT( queue );
 
 			return;
 		}
@@ -1865,12 +2342,15 @@ namespace VSA
 		VkQueue                                     queue,
 		const VkDebugUtilsLabelEXT*                 pLabelInfo)
 	{
-		if ( auto layer = Layer( queue ) )
+		if ( auto dev = _FindDevice( queue ) )
 		{
-			if ( layer->_devFn.QueueInsertDebugUtilsLabelEXT )
-				layer->_devFn.QueueInsertDebugUtilsLabelEXT( queue, pLabelInfo );
+			auto	layer = dev->Layer();
+
+			if ( dev->_devFn.QueueInsertDebugUtilsLabelEXT )
+				dev->_devFn.QueueInsertDebugUtilsLabelEXT( queue, pLabelInfo );
 
-			Call( layer->_fnTable.QueueInsertDebugUtilsLabelEXT, MakeTuple( queue, pLabelInfo ));
+			layer->_Call< Listener_QueueInsertDebugUtilsLabelEXT >( queue, pLabelInfo );
+			layer->_OnInsertLabel( pLabelInfo );
 			return;
 		}
 
@@ -1886,12 +2366,14 @@ namespace VSA
 		VkCommandBuffer                             commandBuffer,
 		const VkDebugUtilsLabelEXT*                 pLabelInfo)
 	{
-		if ( auto layer = Layer( commandBuffer ) )
+		if ( auto dev = _FindDevice( commandBuffer ) )
 		{
-			if ( layer->_devFn.CmdBeginDebugUtilsLabelEXT )
-				layer->_devFn.CmdBeginDebugUtilsLabelEXT( commandBuffer, pLabelInfo );
+			auto	layer = dev->Layer();
+
+			if ( dev->_devFn.CmdBeginDebugUtilsLabelEXT )
+				dev->_devFn.CmdBeginDebugUtilsLabelEXT( commandBuffer, pLabelInfo );
 
-			Call( layer->_fnTable.CmdBeginDebugUtilsLabelEXT, MakeTuple( commandBuffer, pLabelInfo ));
+			layer->_Call< Listener_CmdBeginDebugUtilsLabelEXT >( commandBuffer, pLabelInfo );
 			return;
 		}
 
@@ -1906,12 +2388,14 @@ namespace VSA
 	VKAPI_ATTR void VKAPI_CALL LayerManager::vki_CmdEndDebugUtilsLabelEXT(
 		VkCommandBuffer                             commandBuffer)
 	{
-		if ( auto layer = Layer( commandBuffer ) )
+		if ( auto dev = _FindDevice( commandBuffer ) )
 		{
-			Call( layer->_fnTable.CmdEndDebugUtilsLabelEXT, MakeTuple( commandBuffer ));
+			auto	layer = dev->Layer();
 
-			if ( layer->_devFn.CmdEndDebugUtilsLabelEXT )
-				layer->_devFn.CmdEndDebugUtilsLabelEXT( commandBuffer );
+			layer->_Call< Listener_CmdEndDebugUtilsLabelEXT >( commandBuffer );
+
+			if ( dev->_devFn.CmdEndDebugUtilsLabelEXT )
+				dev->_devFn.CmdEndDebugUtilsLabelEXT( commandBuffer );
 
 			return;
 		}
@@ -1928,12 +2412,14 @@ namespace VSA
 		VkCommandBuffer                             commandBuffer,
 		const VkDebugUtilsLabelEXT*                 pLabelInfo)
 	{
-		if ( auto layer = Layer( commandBuffer ) )
+		if ( auto dev = _FindDevice( commandBuffer ) )
 		{
-			if ( layer->_devFn.CmdInsertDebugUtilsLabelEXT )
-				layer->_devFn.CmdInsertDebugUtilsLabelEXT( commandBuffer, pLabelInfo );
+			auto	layer = dev->Layer();
+
+			if ( dev->_devFn.CmdInsertDebugUtilsLabelEXT )
+				dev->_devFn.CmdInsertDebugUtilsLabelEXT( commandBuffer, pLabelInfo );
 
-			Call( layer->_fnTable.CmdInsertDebugUtilsLabelEXT, MakeTuple( commandBuffer, pLabelInfo ));
+			layer->_Call< Listener_CmdInsertDebugUtilsLabelEXT >( commandBuffer, pLabelInfo );
 			return;
 		}
 
@@ -1966,7 +2452,7 @@ namespace VSA
 
 				auto&	inst = Instance();
 				EXLOCK( inst._lock );
-				inst._windowToLayer.insert_or_assign( pCreateInfo->hwnd, layer );
+				inst._windowToLayer.insert_or_assign( pCreateInfo->hwnd, layer->shared_from_this() );
 			}
 			return result;
 		}
@@ -1991,9 +2477,9 @@ namespace VSA
 
 		if ( msg->message == WM_KEYDOWN and msg->wParam == VK_F11 )
 		{
-			if ( auto layer = LayerFromWnd( msg->hwnd ); layer and not layer->IsStarted() )
+			if ( auto layer = LayerFromWnd( msg->hwnd ))
 			{
-				layer->_Start( _captureSize );
+				layer->_OnCaptureKey();
 			}
 		}
 
@@ -2001,4 +2487,71 @@ namespace VSA
 	}
 #endif
 
+/*
+=================================================
+	vki_SyncAnalyzerBeginCaptureVSA
+=================================================
+*/
+	VKAPI_ATTR VkResult VKAPI_CALL LayerManager::vki_SyncAnalyzerBeginCaptureVSA(
+		VkDevice                                    device,
+		uint32_t                                    frameCount)
+	{
+		if ( auto dev = _FindDevice( device ) )
+		{
+			auto	layer = dev->Layer();
+
+			if ( layer->IsFlightRecorder() or not layer->_Start( frameCount ? frameCount : uint(UMax) ))
+				return VK_NOT_READY;
+
+			VSA_LOGI( String(VSA_LAYER_NAME) << ": capture is started by application" );
+			return VK_SUCCESS;
+		}
+
+		CHECK( false );
+		return VK_RESULT_MAX_ENUM;
+	}
+	
+/*
+=================================================
+	vki_SyncAnalyzerEndCaptureVSA
+=================================================
+*/
+	VKAPI_ATTR VkResult VKAPI_CALL LayerManager::vki_SyncAnalyzerEndCaptureVSA(
+		VkDevice                                    device)
+	{
+		if ( auto dev = _FindDevice( device ) )
+		{
+			auto	layer = dev->Layer();
+
+			if ( layer->IsFlightRecorder() )
+			{
+				layer->_Dump();
+				return VK_SUCCESS;
+			}
+			return layer->_Stop() ? VK_SUCCESS : VK_NOT_READY;
+		}
+
+		CHECK( false );
+		return VK_RESULT_MAX_ENUM;
+	}
+	
+/*
+=================================================
+	vki_SyncAnalyzerMarkFrameVSA
+=================================================
+*/
+	VKAPI_ATTR void VKAPI_CALL LayerManager::vki_SyncAnalyzerMarkFrameVSA(
+		VkDevice                                    device)
+	{
+		if ( auto dev = _FindDevice( device ) )
+		{
+			auto	layer = dev->Layer();
+
+			layer->_EndFrame();
+			return;
+		}
+
+		CHECK( false );
+	}
+
 }	// VSA
@@ -6,11 +6,23 @@
 #include "stl/CompileTime/FunctionInfo.h"
 
 #include "src/IAnalyzer.h"
+#include "src/DispatchKeyMap.h"
+#include "src/CaptureTrigger.h"
+#include "stl/CompileTime/TypeList.h"
 
 #include <mutex>
+#include <atomic>
 
 namespace VSA
 {
+	class SyncAnalyzer;
+
+	// all analyzers, intercepted functions are statically dispatched to them
+	using AnalyzerTypes_t = TypeList< SyncAnalyzer >;
+
+	STATIC_ASSERT( AnalyzerTypes_t::Count <= 32, "bit per analyzer is used" );
+
+
 
 	//
 	// Layer Manager
@@ -21,49 +33,55 @@ namespace VSA
 	// types
 	public:
 		class LayerInstance;
+		class LayerDevice;
 		using LayerInstancePtr	= SharedPtr< LayerInstance >;
 
 	private:
 		template <typename T>
 		using HandleToLayer		= HashMap< T, LayerInstancePtr >;
-		using FnTable_t			= HashMap< String, PFN_vkVoidFunction >;
 
 
 	// variables
 	private:
 		mutable std::mutex				_lock;
-		HandleToLayer<VkInstance>		_instanceToLayer;
-		HandleToLayer<VkPhysicalDevice>	_pdeviceToLayer;
-		HandleToLayer<VkDevice>			_deviceToLayer;
-		HandleToLayer<VkQueue>			_queueToLayer;
-		HandleToLayer<VkCommandBuffer>	_cmdBufferToLayer;
+		HandleToLayer<VkInstance>		_instanceToLayer;		// owns the layer instance
+		HashMap< VkDevice, UniquePtr<LayerDevice> >	_deviceToLayer;	// owns the layer device
 		HandleToLayer<void*>			_windowToLayer;
-		FnTable_t						_instanceTable;
-		FnTable_t						_deviceTable;
+		DispatchKeyMap<LayerInstance>	_dispatchToLayer;		// instances and physical devices, lock-free access on each call, modified under '_lock'
+		DispatchKeyMap<LayerDevice>		_dispatchToDevice;		// devices, queues and command buffers, same as above
+		CaptureTrigger					_trigger;				// control file is polled while any device exists
 		
 		#ifdef VK_USE_PLATFORM_WIN32_KHR
 			HHOOK						_wndHook	= null;
 		#endif
 
-		static constexpr uint			_captureSize = 5;	// frames
-
 
 	// methods
 	public:
 		LayerManager ();
 		~LayerManager ();
 
-		ND_ PFN_vkVoidFunction  GetInstanceFn (const String &name) const;
-		ND_ PFN_vkVoidFunction  GetDeviceFn (const String &name) const;
+		// lock-free and allocation-free, names are resolved by compile-time perfect hash
+		ND_ static PFN_vkVoidFunction  GetInstanceFn (StringView name);
+		ND_ static PFN_vkVoidFunction  GetDeviceFn (StringView name);
 
 		ND_ static LayerManager&  Instance ();
 
-		ND_ static LayerInstancePtr  Layer (VkInstance);
-		ND_ static LayerInstancePtr  Layer (VkPhysicalDevice);
-		ND_ static LayerInstancePtr  Layer (VkDevice);
-		ND_ static LayerInstancePtr  Layer (VkQueue);
-		ND_ static LayerInstancePtr  Layer (VkCommandBuffer);
+		// returned pointer is valid until the instance or device is destroyed,
+		// the application must not use a handle concurrently with destruction of its parent
+		ND_ static LayerInstance*  Layer (VkInstance);
+		ND_ static LayerInstance*  Layer (VkPhysicalDevice);
+		ND_ static LayerInstance*  Layer (VkDevice);
+		ND_ static LayerInstance*  Layer (VkQueue);
+		ND_ static LayerInstance*  Layer (VkCommandBuffer);
 		ND_ static LayerInstancePtr  LayerFromWnd (void* wnd);
+
+	private:
+		template <typename T>
+		ND_ static LayerInstance*  _FindLayer (T handle);
+
+		template <typename T>
+		ND_ static LayerDevice*  _FindDevice (T handle);
 		
 
 	// vulkan interceptor
@@ -392,6 +410,17 @@ namespace VSA
 			VkCommandBuffer                             commandBuffer,
 			const VkDebugUtilsLabelEXT*                 pLabelInfo);
 
+		// layer functions, see 'include/vk_layer_sync_analyzer.h'
+		static VKAPI_ATTR VkResult VKAPI_CALL vki_SyncAnalyzerBeginCaptureVSA(
+			VkDevice                                    device,
+			uint32_t                                    frameCount);
+
+		static VKAPI_ATTR VkResult VKAPI_CALL vki_SyncAnalyzerEndCaptureVSA(
+			VkDevice                                    device);
+
+		static VKAPI_ATTR void VKAPI_CALL vki_SyncAnalyzerMarkFrameVSA(
+			VkDevice                                    device);
+
 	#ifdef VK_USE_PLATFORM_WIN32_KHR
 		static VKAPI_ATTR VkResult VKAPI_CALL vki_CreateWin32SurfaceKHR(
 			VkInstance                                  instance,
@@ -471,6 +500,12 @@ namespace VSA
 		_visitor_( CmdBeginDebugUtilsLabelEXT ) \
 		_visitor_( CmdEndDebugUtilsLabelEXT ) \
 		_visitor_( CmdInsertDebugUtilsLabelEXT )
+
+	// implemented by the layer, not passed to the next layer
+	#define LAYER_FN_LIST( _visitor_ ) \
+		_visitor_( SyncAnalyzerBeginCaptureVSA ) \
+		_visitor_( SyncAnalyzerEndCaptureVSA ) \
+		_visitor_( SyncAnalyzerMarkFrameVSA )
 	
 
 
@@ -481,30 +516,10 @@ namespace VSA
 	class LayerManager::LayerInstance final : public std::enable_shared_from_this< LayerInstance >
 	{
 		friend class LayerManager;
+		friend class LayerManager::LayerDevice;
 
 	// types
 	private:
-		template <typename Fn>
-		struct _Callback2 {
-			using _FI = FunctionInfo< Fn >;
-			using type = Function< void (const typename _FI::args::AsTuple &) >;
-		};
-
-		template <typename Fn>
-		struct _Callback3 {
-			using _FI = FunctionInfo< Fn >;
-			using type = Function< void (const typename _FI::args::AsTuple &, typename _FI::result) >;
-		};
-
-		template <typename Fn>
-		struct Callback {
-			using fn_type = typename Conditional<
-								std::is_void_v< typename FunctionInfo< Fn >::result >,
-								_Callback2< Fn> , 
-								_Callback3< Fn > >::type;
-			using type = Array< fn_type >;
-		};
-
 		template <typename Fn>
 		struct FnWrap {
 			using _FI = FunctionInfo< Fn >;
@@ -528,16 +543,44 @@ namespace VSA
 
 		using Analyzers_t = Array< SharedPtr< IAnalyzer >>;
 
+		template <typename TL>
+		struct _ListenersTuple;
+
+		template <typename ...Types>
+		struct _ListenersTuple< TypeList< Types... >> {
+			using type = Tuple< SharedPtr< Types >... >;
+		};
+
+		using Listeners_t = typename _ListenersTuple< AnalyzerTypes_t >::type;
+
+		#define VISITOR( _name_ )	+1
+		static constexpr size_t		_DeviceFnCount	= 0 DEVICE_FN_LIST( VISITOR );
+		#undef VISITOR
+
+		using DeviceProcs_t = StaticArray< PFN_vkVoidFunction, _DeviceFnCount >;
+
+		struct DeviceFn_t {
+			#define VISITOR( _name_ )	FnWrap< PFN_vk ## _name_ >  _name_;
+			DEVICE_FN_LIST( VISITOR )
+			#undef VISITOR
+		};
+
 
 	// variables
 	private:
 		VkInstance					_instance				= VK_NULL_HANDLE;
-		VkPhysicalDevice			_physicalDevice			= VK_NULL_HANDLE;
-		VkDevice					_logicalDevice			= VK_NULL_HANDLE;
 		PFN_vkGetInstanceProcAddr	_getInstanceProcAddr	= null;
-		PFN_vkGetDeviceProcAddr		_getDeviceProcAddr		= null;
-		Analyzers_t					_analyzers;
-		int							_capturedFrames			= -1;
+		Analyzers_t					_analyzers;				// for Start/Stop and other rare calls
+		Listeners_t					_listeners;				// intercepted functions are called directly
+		std::atomic<uint>			_enabledListeners		{~0u};	// bit per analyzer in 'AnalyzerTypes_t'
+		std::atomic<int>			_capturedFrames			{0};	// capture gate, sync callbacks are skipped when zero, negative in flight recorder mode
+		std::mutex					_controlGuard;					// serializes start, stop and dump, they can be requested by the application and by triggers
+		std::atomic<uint>			_framesToTrigger		{0};	// frames until capture is triggered, zero if disabled or already triggered
+		std::atomic<uint>			_consumedTriggers		{0};	// last 'CaptureTrigger' request handled by this instance
+
+		const uint					_frameSubmits;					// frame delimiters for applications without swapchain, see 'LayerSettings'
+		std::atomic<uint>			_submitCounter			{0};
+		std::atomic<uint64_t>		_frameFence				{0};	// fence with 'LayerSettings::frameFence' debug name
 
 		struct {
 			#ifdef VK_USE_PLATFORM_WIN32_KHR
@@ -546,13 +589,6 @@ namespace VSA
 			#endif
 		}							_os;
 
-		struct {
-			#define VISITOR( _name_ )	typename Callback< PFN_vk ## _name_ >::type  _name_;
-			INSTANCE_FN_LIST( VISITOR )
-			DEVICE_FN_LIST( VISITOR )
-			#undef VISITOR
-		}							_fnTable;
-		
 		struct {
 			#define VISITOR( _name_ )	FnWrap< PFN_vk ## _name_ >  _name_;
 			INSTANCE_FN_LIST( VISITOR )
@@ -563,34 +599,88 @@ namespace VSA
 			#endif
 		}							_instFn;
 
-		struct {
-			#define VISITOR( _name_ )	FnWrap< PFN_vk ## _name_ >  _name_;
-			DEVICE_FN_LIST( VISITOR )
-			#undef VISITOR
-		}							_devFn;
-
 
 	// methods
 	public:
 		LayerInstance ();
 
-		ND_ bool						IsStarted ()		const	{ return _capturedFrames > 0; }
+		ND_ bool						IsStarted ()		const	{ return _capturedFrames.load( std::memory_order_relaxed ) != 0; }
+		ND_ bool						IsFlightRecorder ()	const	{ return _capturedFrames.load( std::memory_order_relaxed ) < 0; }
+		ND_ uint64_t					BeginCall ()		const	{ return IsStarted() ? PerformanceCounter::Now() : 0; }
 
 		ND_ VkInstance					Instance ()			const	{ return _instance; }
-		ND_ VkPhysicalDevice			PhysicalDevice ()	const	{ return _physicalDevice; }
-		ND_ VkDevice					LogicalDevice ()	const	{ return _logicalDevice; }
-			
 		ND_ PFN_vkGetInstanceProcAddr	InstanceProcAddr ()	const	{ return _getInstanceProcAddr; }
-		ND_ PFN_vkGetDeviceProcAddr		DeviceProcAddr ()	const	{ return _getDeviceProcAddr; }
+
+		template <typename T>
+		void  SetEnabled (bool enabled)
+		{
+			STATIC_ASSERT( AnalyzerTypes_t::HasType<T> );
+			const uint	bit = 1u << AnalyzerTypes_t::Index<T>;
+			if ( enabled )	_enabledListeners.fetch_or( bit, std::memory_order_relaxed );
+			else			_enabledListeners.fetch_and( ~bit, std::memory_order_relaxed );
+		}
 
 	private:
 		void _Init1 (VkInstance inst, PFN_vkGetInstanceProcAddr gpa);
-		void _Init2 (VkPhysicalDevice pd, VkDevice ld, PFN_vkGetDeviceProcAddr gpa);
+		void _Init2 (LayerDevice &dev);
 
 		void _RegisterSyncAnalyzer ();
 
-		void _Start (uint frames);
+		template <typename L, typename ...Args>
+		void  _Call (const Args& ...args) const;
+
+		template <typename L, size_t ...I, typename ...Args>
+		void  _CallListeners (std::index_sequence<I...>, const Args& ...args) const;
+
+		bool _Start (uint frames);
+		bool _Stop ();
+		void _StartFlightRecorder (uint frames);
+		void _Dump ();
 		void _Update ();
+		void _OnCaptureKey ();
+
+		void _EndFrame ();
+		void _OnSubmit ();
+		void _OnInsertLabel (const VkDebugUtilsLabelEXT* pLabelInfo);
+		void _OnWaitForFences (uint fenceCount, const VkFence* pFences, VkBool32 waitAll);
+		void _OnSetFenceName (uint64_t fence, const char* name);
+	};
+
+
+
+	//
+	// Layer Device
+	//
+	// Functions of the next layer are queried for each device,
+	// so they are stored per device and shared analyzers are accessed through the layer instance.
+	//
+
+	class LayerManager::LayerDevice final
+	{
+		friend class LayerManager;
+		friend class LayerManager::LayerInstance;
+
+	// variables
+	private:
+		const LayerInstancePtr				_layer;					// device keeps the layer instance alive
+		const VkPhysicalDevice				_physicalDevice;
+		const VkDevice						_logicalDevice;
+		const PFN_vkGetDeviceProcAddr		_getDeviceProcAddr;
+
+		LayerInstance::DeviceFn_t			_devFn;
+		LayerInstance::DeviceProcs_t		_deviceProcs	= {};	// returned by 'vkGetDeviceProcAddr', in 'DEVICE_FN_LIST' order
+
+
+	// methods
+	public:
+		LayerDevice (LayerInstancePtr layer, VkPhysicalDevice pd, VkDevice ld, PFN_vkGetDeviceProcAddr gpa) :
+			_layer{std::move(layer)}, _physicalDevice{pd}, _logicalDevice{ld}, _getDeviceProcAddr{gpa}
+		{}
+
+		ND_ LayerInstance*				Layer ()			const	{ return _layer.get(); }
+		ND_ VkPhysicalDevice			PhysicalDevice ()	const	{ return _physicalDevice; }
+		ND_ VkDevice					LogicalDevice ()	const	{ return _logicalDevice; }
+		ND_ PFN_vkGetDeviceProcAddr		DeviceProcAddr ()	const	{ return _getDeviceProcAddr; }
 	};
 
 }	// VSA
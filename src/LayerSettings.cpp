@@ -0,0 +1,131 @@
+// Copyright (c) 2019,  Zhirnov Andrey. For more information see 'LICENSE'
+
+#include "src/LayerSettings.h"
+#include "stl/Algorithms/StringUtils.h"
+
+#ifdef COMPILER_MSVC
+#	pragma warning (disable: 4996)	// 'getenv' may be unsafe
+#endif
+
+namespace VSA
+{
+
+/*
+=================================================
+	GetEnv
+=================================================
+*/
+	ND_ static StringView  GetEnv (const char* name)
+	{
+		const char*	value = std::getenv( name );
+		return value ? StringView{value} : StringView{};
+	}
+
+/*
+=================================================
+	ParseBytes
+----
+	supported formats: '4096', '64K', '16M'
+=================================================
+*/
+	static void  ParseBytes (const char* name, INOUT BytesU &result)
+	{
+		StringView	str = GetEnv( name );
+		if ( str.empty() )
+			return;
+
+		uint64_t	value	= 0;
+		size_t		i		= 0;
+
+		for (; i < str.size() and str[i] >= '0' and str[i] <= '9'; ++i) {
+			value = value * 10 + uint64_t(str[i] - '0');
+		}
+
+		if ( i < str.size() )
+		{
+			switch ( str[i] ) {
+				case 'k' : case 'K' :	value <<= 10;	break;
+				case 'm' : case 'M' :	value <<= 20;	break;
+				default :				value = 0;		break;
+			}
+		}
+
+		if ( value == 0 )
+		{
+			VSA_LOGI( "invalid value of '"s << name << "': '" << str << "'" );
+			return;
+		}
+		result = BytesU{ value };
+	}
+
+/*
+=================================================
+	ParseUInt
+=================================================
+*/
+	static void  ParseUInt (const char* name, INOUT uint &result)
+	{
+		StringView	str = GetEnv( name );
+		if ( str.empty() )
+			return;
+
+		uint	value	= 0;
+		for (char c : str)
+		{
+			if ( c < '0' or c > '9' )
+			{
+				VSA_LOGI( "invalid value of '"s << name << "': '" << str << "'" );
+				return;
+			}
+			value = value * 10 + uint(c - '0');
+		}
+		result = value;
+	}
+//-----------------------------------------------------------------------------
+
+
+/*
+=================================================
+	constructor
+=================================================
+*/
+	LayerSettings::LayerSettings ()
+	{
+		ParseBytes( "VSA_THREAD_ARENA_BLOCK_SIZE", INOUT threadArenaBlockSize );
+		ParseBytes( "VSA_CAPTURE_ARENA_BLOCK_SIZE", INOUT captureArenaBlockSize );
+		ParseUInt( "VSA_CAPTURE_FRAMES", INOUT captureFrames );
+		ParseUInt( "VSA_FLIGHT_RECORDER_FRAMES", INOUT flightRecorderFrames );
+		ParseUInt( "VSA_CAPTURE_START_FRAME", INOUT captureStartFrame );
+		ParseUInt( "VSA_FRAME_SUBMITS", INOUT frameSubmits );
+
+		ParseUInt( "VSA_CAPTURE_SIGNAL", INOUT captureSignal );
+
+		traceFile	= String{ GetEnv( "VSA_TRACE_FILE" )};
+		controlFile	= String{ GetEnv( "VSA_CONTROL_FILE" )};
+		frameLabel	= String{ GetEnv( "VSA_FRAME_LABEL" )};
+		frameFence	= String{ GetEnv( "VSA_FRAME_FENCE" )};
+
+	#ifdef PLATFORM_WINDOWS
+		graphFile = "C:\\Projects\\sync_graph_v1.dot";
+	#else
+		graphFile = "sync_graph_v1.dot";
+	#endif
+		if ( auto file = GetEnv( "VSA_GRAPH_FILE" ); not file.empty() )
+			graphFile = String{ file };
+
+		if ( auto formats = GetEnv( "VSA_GRAPH_FORMATS" ); formats.data() )
+			graphFormats = String{ formats };
+	}
+	
+/*
+=================================================
+	Get
+=================================================
+*/
+	LayerSettings const&  LayerSettings::Get ()
+	{
+		static const LayerSettings	inst;
+		return inst;
+	}
+
+}	// VSA
@@ -0,0 +1,40 @@
+// Copyright (c) 2019,  Zhirnov Andrey. For more information see 'LICENSE'
+
+#pragma once
+
+#include "stl/Common.h"
+#include "stl/Math/Bytes.h"
+
+namespace VSA
+{
+
+	//
+	// Layer Settings
+	//
+
+	struct LayerSettings
+	{
+	// variables
+		BytesU		threadArenaBlockSize	= 64_Kb;	// VSA_THREAD_ARENA_BLOCK_SIZE
+		BytesU		captureArenaBlockSize	= 1_Mb;		// VSA_CAPTURE_ARENA_BLOCK_SIZE
+		uint		captureFrames			= 5;		// VSA_CAPTURE_FRAMES, number of frames captured by hotkey
+		uint		flightRecorderFrames	= 0;		// VSA_FLIGHT_RECORDER_FRAMES, 0 - disabled, capture is started by hotkey
+		uint		captureStartFrame		= 0;		// VSA_CAPTURE_START_FRAME, 0 - disabled, capture is triggered after N-th frame
+		uint		captureSignal			= 0;		// VSA_CAPTURE_SIGNAL, signal number, 0 - disabled (default)
+		uint		frameSubmits			= 0;		// VSA_FRAME_SUBMITS, 0 - disabled, frame is ended by each N-th vkQueueSubmit
+		String		frameLabel;							// VSA_FRAME_LABEL, frame is ended by vkQueueInsertDebugUtilsLabelEXT with this label
+		String		frameFence;							// VSA_FRAME_FENCE, frame is ended by vkWaitForFences with fence that has this debug name
+		String		controlFile;						// VSA_CONTROL_FILE, capture is triggered when this file is created, the file is removed by the layer
+		String		traceFile;							// VSA_TRACE_FILE, if not empty capture is streamed into the binary trace
+		String		graphFile;							// VSA_GRAPH_FILE, dot-file for captures, capture index is added to the name
+		String		graphFormats			= "png";	// VSA_GRAPH_FORMATS, comma separated graphviz output formats, empty - graph is not rendered
+
+	// methods
+		ND_ static LayerSettings const&  Get ();
+
+	private:
+		LayerSettings ();
+	};
+
+
+}	// VSA
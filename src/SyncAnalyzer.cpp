@@ -2,6 +2,7 @@
 
 #include "stl/Platforms/WindowsHeader.h"
 
+#ifdef PLATFORM_WINDOWS
 # ifdef COMPILER_MSVC
 #	pragma warning (push)
 #	pragma warning (disable: 4668)
@@ -11,13 +12,17 @@
 # else
 #	include <processthreadsapi.h>
 # endif
+#else
+#	include <pthread.h>
+#endif
 
 #include "src/SyncAnalyzer.h"
+#include "src/LayerSettings.h"
+#include "stl/Platforms/PerformanceCounter.h"
 #include "stl/Algorithms/StringUtils.h"
 #include "stl/Containers/ArrayView.h"
-#include "stl/Stream/FileStream.h"
 
-#include <filesystem>
+#include <algorithm>
 
 namespace VSA
 {
@@ -45,6 +50,17 @@ namespace VSA
 		get_queue_family_props( pd, INOUT &count, OUT dev.queue_props.data() );
 	}
 
+/*
+=================================================
+	constructor
+=================================================
+*/
+	SyncAnalyzer::SyncAnalyzer ()
+		: _recorderId{ []() { static std::atomic<uint> counter {0};  return ++counter; }() }
+	{
+		_captureArena.SetBlockSize( LayerSettings::Get().captureArenaBlockSize );
+	}
+
 /*
 =================================================
 	Start
@@ -52,9 +68,17 @@ namespace VSA
 */
 	void SyncAnalyzer::Start ()
 	{
-		_enabled	= true;
-		_startTime	= TimePoint_t::clock::now();
 		_Clear();
+
+		// stream events to the file instead of keeping them in memory
+		if ( auto& filename = LayerSettings::Get().traceFile; not filename.empty() )
+		{
+			EXLOCK( _frameGuard );
+			_trace.Open( filename );
+		}
+
+		_startTime.store( PerformanceCounter::Now(), std::memory_order_relaxed );
+		_enabled.store( true, std::memory_order_release );
 	}
 	
 /*
@@ -64,84 +88,512 @@ namespace VSA
 */
 	void SyncAnalyzer::Stop ()
 	{
-		_SaveDotFile_v1();
-		//_SaveDotFile_v2();
+		_enabled.store( false, std::memory_order_release );
+
+		if ( _StopTrace() )
+			return;
+
+		// events are exported by the background thread
+		CaptureExporter::Capture	capture;
+		_SwapThreadEvents( INOUT capture.buffers );
+
+		if ( capture.buffers.size() )
+		{
+			_CopyQueueNames( INOUT capture.buffers.front()->events );
+			_exporter.Export( std::move(capture) );
+		}
 		_Clear();
-		_enabled = false;
 	}
 	
 /*
 =================================================
-	_Clear
+	_StopTrace
+----
+	writes events of the last frame and closes the trace file,
+	returns false if the trace was not started.
 =================================================
 */
-	void SyncAnalyzer::_Clear ()
+	bool SyncAnalyzer::_StopTrace ()
 	{
-		_globalSyncs.clear();
-		_signalSemaphores.clear();
-		_signalFences.clear();
-		_swapchains.clear();
-		_uidCounter = 0;
+		{
+			EXLOCK( _frameGuard );
+
+			if ( not _trace.IsOpen() )
+				return false;
+
+			_MergeThreadEvents( INOUT _capture );
+
+			if ( not _capture.events.empty() )
+			{
+				_CopyQueueNames( INOUT _capture );
+				_trace.AddFrame( _capture );
+			}
+
+			_trace.Close();
+
+			VSA_LOGI( String(VSA_LAYER_NAME) << ": trace saved into '" << LayerSettings::Get().traceFile << "', "
+						<< ToString( _trace.FrameCount() ) << " frames (" << ToString( _trace.FramesDropped() ) << " dropped), "
+						<< ToString( _trace.ChunksWritten() ) << " chunks, " << ToString( _trace.BytesWritten() )
+						<< " (raw " << ToString( _trace.RawSize() ) << ")"
+						<< ", max queued chunks " << ToString( _trace.MaxQueuedChunks() ));
+		}
+
+		_LogMemoryUsage();
+		_Clear();
+		return true;
 	}
+	
+/*
+=================================================
+	StartFlightRecorder
+----
+	events are recorded until 'Stop()' and only last 'frames' frames are kept,
+	memory is reused after the ring is filled.
+	does nothing if recording is already started, so the ring is not discarded.
+=================================================
+*/
+	void SyncAnalyzer::StartFlightRecorder (uint frames)
+	{
+		if ( _enabled.load( std::memory_order_acquire ))
+			return;
 
+		_Clear();
+		{
+			EXLOCK( _frameGuard );
+
+			_frameRing.resize( Max( frames, 1u ));
+			for (auto& slot : _frameRing)
+			{
+				if ( not slot )
+				{
+					slot.reset( new EventStorage{} );
+					slot->arena.SetBlockSize( LayerSettings::Get().threadArenaBlockSize );
+				}
+			}
+		}
+
+		_startTime.store( PerformanceCounter::Now(), std::memory_order_relaxed );
+		_enabled.store( true, std::memory_order_release );
+	}
+	
 /*
 =================================================
-	_GetThreadID
+	Dump
+----
+	exports frames from the ring, recording continues.
+	frames are copied, because the ring is still in use,
+	export is done by the background thread.
 =================================================
 */
-	SyncAnalyzer::ThreadID  SyncAnalyzer::_GetThreadID ()
+	void SyncAnalyzer::Dump ()
 	{
-		EXLOCK( _lock );
+		auto	storage = _exporter.AcquireStorage();
+		auto&	dst		= storage->events;
+		{
+			EXLOCK( _frameGuard );
+			
+			const size_t	ring_size = _frameRing.size();
+
+			for (size_t i = 0; i < _ringFrames; ++i)
+			{
+				auto&	slot = _frameRing[ (_ringPos + ring_size - _ringFrames + i) % ring_size ]->events;
 
-		auto	id		= std::this_thread::get_id();
-		auto	iter	= _threadIds.find( id );
+				dst.Append( slot );
+
+				for (auto& item : slot.threadNames)
+				{
+					const ThreadID	tid { uint(item.object) };
+
+					if ( dst.FindThreadName( tid ).empty() )
+						dst.SetThreadName( tid, slot.GetString( item.name ));
+				}
+			}
+		}
 
-		if ( iter != _threadIds.end() )
-			return iter->second;
+		if ( dst.events.empty() )
+			return;
 		
-		ThreadID	tid		{++_threadIdCounter};
-		PWSTR		w_name;
+		_CopyQueueNames( INOUT dst );
+
+		CaptureExporter::Capture	capture;
+		capture.buffers.push_back( std::move(storage) );
+		_exporter.Export( std::move(capture) );
+	}
+	
+/*
+=================================================
+	EndFrame
+----
+	moves events of the last frame into the ring.
+=================================================
+*/
+	void SyncAnalyzer::EndFrame ()
+	{
+		if ( not _enabled.load( std::memory_order_relaxed ))
+			return;
+
+		EXLOCK( _frameGuard );
+
+		// write frame to the trace, '_capture' is used as temporary buffer
+		if ( _trace.IsOpen() )
+		{
+			_MergeThreadEvents( INOUT _capture );
+			_CopyQueueNames( INOUT _capture );
+			_trace.AddFrame( _capture );
+
+			_capture.Clear();
+			_captureArena.Discard();
+			return;
+		}
+
+		if ( _frameRing.empty() )
+			return;
+
+		auto&	slot = *_frameRing[ _ringPos ];
+		
+		// overwrite the oldest frame
+		slot.events.Clear();
+		slot.arena.Discard();
+
+		_MergeThreadEvents( INOUT slot.events );
+
+		_ringPos	= (_ringPos + 1) % _frameRing.size();
+		_ringFrames	= Min( _ringFrames + 1, _frameRing.size() );
+	}
+	
+/*
+=================================================
+	_CopyQueueNames
+=================================================
+*/
+	void SyncAnalyzer::_CopyQueueNames (INOUT SyncEventBuffer &dst)
+	{
+		EXLOCK( _lock );
+
+		for (auto& [queue, info] : _queues) {
+			dst.SetQueueName( HandleToU64( queue ), info.name );
+		}
+	}
+
+/*
+=================================================
+	_Clear
+=================================================
+*/
+	void SyncAnalyzer::_Clear ()
+	{
+		{
+			EXLOCK( _threadEventsGuard );
+			for (auto iter = _threadEvents.begin(); iter != _threadEvents.end();)
+			{
+				if ( iter->second->retired.load( std::memory_order_acquire ))
+				{
+					iter = _threadEvents.erase( iter );
+					continue;
+				}
+
+				EXLOCK( iter->second->guard );
+				iter->second->storage->events.Clear();
+				iter->second->storage->arena.Discard();
+				++iter;
+			}
+		}
+		{
+			EXLOCK( _frameGuard );
+			_capture.Clear();
+			_captureArena.Discard();
+
+			for (auto& slot : _frameRing)
+			{
+				slot->events.Clear();
+				slot->arena.Discard();
+			}
+			_ringPos	= 0;
+			_ringFrames	= 0;
+		}
+	}
+	
+/*
+=================================================
+	_LogMemoryUsage
+=================================================
+*/
+	void SyncAnalyzer::_LogMemoryUsage ()
+	{
+		BytesU	thread_used, thread_max, thread_capacity;
+		{
+			EXLOCK( _threadEventsGuard );
+			for (auto& item : _threadEvents)
+			{
+				EXLOCK( item.second->guard );
+				thread_used		+= item.second->storage->arena.UsedSize();
+				thread_max		+= item.second->storage->arena.HighWaterMark();
+				thread_capacity	+= item.second->storage->arena.Capacity();
+			}
+		}
+
+		String	str;
+		str << VSA_LAYER_NAME << ": capture arena: used " << ToString( _captureArena.UsedSize() )
+			<< ", high-water " << ToString( _captureArena.HighWaterMark() ) << ", capacity " << ToString( _captureArena.Capacity() )
+			<< "; thread arenas: used " << ToString( thread_used ) << ", high-water " << ToString( thread_max )
+			<< ", capacity " << ToString( thread_capacity );
+		{
+			EXLOCK( _frameGuard );
+			if ( _frameRing.size() )
+			{
+				BytesU	ring_used, ring_capacity;
+				for (auto& slot : _frameRing)
+				{
+					ring_used		+= slot->arena.UsedSize();
+					ring_capacity	+= slot->arena.Capacity();
+				}
+				str << "; frame ring (" << ToString( _ringFrames ) << " frames): used " << ToString( ring_used )
+					<< ", capacity " << ToString( ring_capacity );
+			}
+		}
+		VSA_LOGI( str );
+	}
+
+//-----------------------------------------------------------------------------
+
+
+	//
+	// Thread Slot
+	//
+
+	struct SyncAnalyzer::ThreadSlot
+	{
+	// variables
+		ThreadID						id			{0};
+		String							name;
+		uint							recorderId	= 0;		// last used analyzer
+		ThreadEvents*					events		= null;		// event buffer in last used analyzer
+		Array<WeakPtr<ThreadEvents>>	buffers;				// buffers in all analyzers, marked as retired at thread exit
+
+	// methods
+		ThreadSlot () {}
+		~ThreadSlot ();
+	};
+	
+/*
+=================================================
+	destructor
+=================================================
+*/
+	SyncAnalyzer::ThreadSlot::~ThreadSlot ()
+	{
+		for (auto& weak : buffers)
+		{
+			if ( auto te = weak.lock() )
+				te->retired.store( true, std::memory_order_release );
+		}
+	}
+	
+/*
+=================================================
+	GetCurrentThreadName
+=================================================
+*/
+	ND_ static String  GetCurrentThreadName (ThreadID tid)
+	{
+		String		name;
+
+	#ifdef PLATFORM_WINDOWS
+		PWSTR		w_name	= null;
 		HRESULT		hr		= ::GetThreadDescription( ::GetCurrentThread(), OUT &w_name );	// Win10 only	// TODO: use dynamic linking
 
-		if ( SUCCEEDED(hr) and w_name and *w_name )
+		if ( SUCCEEDED(hr) and w_name )
 		{
-			String	name;
 			name.reserve( 128 );
 
-			for (; *w_name; ++w_name) { 
-				if ( (*w_name >= 0) & (*w_name < 128) )
-					name.push_back( char(*w_name) );
+			for (PCWSTR c = w_name; *c; ++c) { 
+				if ( (*c >= 0) & (*c < 128) )
+					name.push_back( char(*c) );
 			}
-
-			_threadNames.insert_or_assign( tid, std::move(name) );
+			::LocalFree( w_name );
 		}
-		else
+	#else
+		char	buf [16] = {};	// linux limit, including null terminator
+
+		if ( ::pthread_getname_np( ::pthread_self(), OUT buf, CountOf(buf) ) == 0 )
+			name = buf;
+	#endif
+
+		if ( name.empty() )
+			name = "Thread_"s << ToString( uint(tid) );
+
+		return name;
+	}
+
+/*
+=================================================
+	_GetThreadSlot
+----
+	thread id and name are shared between all analyzers,
+	name is requested only at first call from the thread.
+=================================================
+*/
+	SyncAnalyzer::ThreadSlot&  SyncAnalyzer::_GetThreadSlot ()
+	{
+		static thread_local ThreadSlot	t_slot;
+
+		if_likely( t_slot.id != ThreadID(0) )
+			return t_slot;
+
+		static std::atomic<uint>	counter {0};
+
+		t_slot.id	= ThreadID{ ++counter };
+		t_slot.name	= GetCurrentThreadName( t_slot.id );
+		return t_slot;
+	}
+//-----------------------------------------------------------------------------
+
+
+/*
+=================================================
+	_GetCallTime
+----
+	must be called from the thread that made the intercepted call
+=================================================
+*/
+	CallTime  SyncAnalyzer::_GetCallTime () const
+	{
+		const uint64_t	end		= PerformanceCounter::Now();
+		const uint64_t	entry	= CallEntryTime();
+		const uint64_t	start	= _startTime.load( std::memory_order_relaxed );
+
+		// entry time is unknown if capturing was started during the call
+		const uint64_t	begin	= (entry != 0 and entry <= end) ? Max( entry, start ) : end;
+
+		return CallTime{ TimePoint{ begin - start }, TimePoint{ end - start }};
+	}
+	
+/*
+=================================================
+	_GetThreadEvents
+----
+	returns event buffer for current thread,
+	global lock is used only at first call from the thread.
+=================================================
+*/
+	SyncAnalyzer::ThreadEvents*  SyncAnalyzer::_GetThreadEvents ()
+	{
+		ThreadSlot&	slot = _GetThreadSlot();
+
+		if_likely( slot.recorderId == _recorderId )
+			return slot.events;
+
+		EXLOCK( _threadEventsGuard );
+
+		auto&	te = _threadEvents[ slot.id ];
+		if ( not te )
 		{
-			_threadNames.insert_or_assign( tid, "Thread_"s << ToString( uint(tid) ));
+			te = MakeShared<ThreadEvents>();
+			te->threadId	= slot.id;
+			te->name		= slot.name;
+			te->storage		= _exporter.AcquireStorage();
+
+			// forget buffers of destroyed analyzers
+			slot.buffers.erase( std::remove_if( slot.buffers.begin(), slot.buffers.end(), [] (auto& weak) { return weak.expired(); }),
+								slot.buffers.end() );
+			slot.buffers.push_back( te );
 		}
 
-		return _threadIds.insert_or_assign( id, tid ).first->second;
+		slot.recorderId	= _recorderId;
+		slot.events		= te.get();
+		return te.get();
+	}
+	
+/*
+=================================================
+	_AddEvents
+----
+	'fn' writes events into the thread buffer
+=================================================
+*/
+	template <typename FN>
+	void  SyncAnalyzer::_AddEvents (FN &&fn)
+	{
+		ThreadEvents*	te = _GetThreadEvents();
+		EXLOCK( te->guard );
+
+		// 'Stop()' may already have collected this buffer
+		if ( not _enabled.load( std::memory_order_acquire ))
+			return;
+
+		fn( te->storage->events, te->threadId, _GetCallTime() );
 	}
 	
 /*
 =================================================
-	_GetTimePoint
+	_MergeThreadEvents
 =================================================
 */
-	SyncAnalyzer::TimePoint  SyncAnalyzer::_GetTimePoint ()
+	void  SyncAnalyzer::_MergeThreadEvents (INOUT SyncEventBuffer &dst)
 	{
-		auto	time = TimePoint_t::clock::now();
-		return TimePoint{ std::chrono::duration_cast< std::chrono::microseconds >( time - _startTime ).count() };
+		// move events and copy names, so the 'dst' doesn't depend on the analyzer state
+		EXLOCK( _threadEventsGuard );
+
+		for (auto iter = _threadEvents.begin(); iter != _threadEvents.end();)
+		{
+			auto&	te		= *iter->second;
+			bool	retired	= false;
+			{
+				EXLOCK( te.guard );
+
+				// thread has exited, so all its events are already in the buffer
+				retired = te.retired.load( std::memory_order_acquire );
+
+				if ( not te.storage->events.events.empty() )
+				{
+					dst.Append( te.storage->events );
+					dst.SetThreadName( te.threadId, te.name );
+				}
+				te.storage->events.Clear();
+				te.storage->arena.Discard();
+			}
+
+			if ( retired )
+				iter = _threadEvents.erase( iter );
+			else
+				++iter;
+		}
 	}
 	
 /*
 =================================================
-	_GetUID
+	_SwapThreadEvents
+----
+	non-empty thread buffers are replaced by empty buffers
+	without copying, thread names are stored in the buffers.
 =================================================
 */
-	SyncAnalyzer::UID  SyncAnalyzer::_GetUID ()
+	void  SyncAnalyzer::_SwapThreadEvents (INOUT Array<UniquePtr<EventStorage>> &dst)
 	{
-		return UID{ ++_uidCounter };
+		EXLOCK( _threadEventsGuard );
+
+		for (auto iter = _threadEvents.begin(); iter != _threadEvents.end();)
+		{
+			auto&	te		= *iter->second;
+			bool	retired	= false;
+			{
+				EXLOCK( te.guard );
+
+				retired = te.retired.load( std::memory_order_acquire );
+
+				if ( not te.storage->events.events.empty() )
+				{
+					te.storage->events.SetThreadName( te.threadId, te.name );
+					dst.push_back( std::move(te.storage) );
+					te.storage = _exporter.AcquireStorage();
+				}
+			}
+
+			if ( retired )
+				iter = _threadEvents.erase( iter );
+			else
+				++iter;
+		}
 	}
 	
 /*
@@ -167,6 +619,49 @@ namespace VSA
 		return str << ToString( queueIndex );
 	}
 
+/*
+=================================================
+	vki_DestroyDevice
+----
+	queue handles may be reused by the next device,
+	names are copied into the current capture before they are removed.
+=================================================
+*/
+	void SyncAnalyzer::vki_DestroyDevice(
+		VkDevice                                    device,
+		const VkAllocationCallbacks*                )
+	{
+		Array<QueueInfo>	queues;
+		{
+			EXLOCK( _lock );
+
+			auto	iter = _devices.find( device );
+			if ( iter == _devices.end() )
+				return;
+
+			for (auto& q : iter->second.queues)
+			{
+				auto	q_iter = _queues.find( q );
+				if ( q_iter != _queues.end() )
+				{
+					queues.push_back( std::move(q_iter->second) );
+					_queues.erase( q_iter );
+				}
+			}
+			_devices.erase( iter );
+		}
+
+		if ( queues.empty() or not _enabled.load( std::memory_order_relaxed ))
+			return;
+
+		_AddEvents( [&] (SyncEventBuffer &buf, ThreadID, const CallTime &)
+		{
+			for (auto& q : queues) {
+				buf.SetQueueName( HandleToU64( q.id ), q.name );
+			}
+		});
+	}
+
 /*
 =================================================
 	vki_GetDeviceQueue
@@ -232,74 +727,24 @@ namespace VSA
 		VkFence                                     fence,
 		VkResult                                    result)
 	{
-		if ( result != VK_SUCCESS )
+		if ( result != VK_SUCCESS or not _enabled.load( std::memory_order_relaxed ))
 			return;
 
-		EXLOCK( _lock );
-
-		if ( not _enabled )
-			return;
-
-		const auto	tid		= _GetThreadID();
-		const auto	time	= _GetTimePoint();
-		const auto	dev		= _queues[queue].dev;
-		
-		if ( fence )
-			_signalFences[ fence ].clear();
-
-		QueueSubmit		cmd_submit;
-		cmd_submit.threadId	= tid;
-		cmd_submit.time		= time;
-		cmd_submit.dev		= dev;
-		cmd_submit.uid		= _GetUID();
-
-		FenceSignal		cmd_signal;
-		cmd_signal.threadId	= tid;
-		cmd_signal.time		= TimePoint( uint(time) + 1);
-		cmd_signal.dev		= dev;
-		cmd_signal.uid		= _GetUID();
-		cmd_signal.queue	= queue;
-
-		for (uint i = 0; i < submitCount; ++i)
+		_AddEvents( [&] (SyncEventBuffer &buf, ThreadID tid, const CallTime &time)
 		{
-			const auto&	submit = pSubmits[i];
-
-			CmdBatch		cmd;
-			cmd.threadId	= tid;
-			cmd.time		= time;
-			cmd.dev			= dev;
-			cmd.uid			= _GetUID();
-			cmd.queue		= queue;
-			cmd.signalSemaphores.assign( submit.pSignalSemaphores, submit.pSignalSemaphores + submit.signalSemaphoreCount );
-			cmd.waitSemaphores.assign( submit.pWaitSemaphores, submit.pWaitSemaphores + submit.waitSemaphoreCount );
-
-			for (uint j = 0; j < submit.waitSemaphoreCount; ++j)
+			auto&	cmd = buf.Add( ESyncEvent::QueueSubmit, tid, time, HandleToU64( queue ));
+			cmd.submit.fence		= HandleToU64( fence );
+			cmd.submit.batchCount	= submitCount;
+
+			for (uint i = 0; i < submitCount; ++i)
 			{
-				auto	iter = _signalSemaphores.find( submit.pWaitSemaphores[j] );
-				if ( iter != _signalSemaphores.end() )
-				{
-					cmd.waitDeps.push_back( iter->second );
-					_signalSemaphores.erase( iter );
-				}
-			}
+				const auto&	submit	= pSubmits[i];
+				auto&		batch	= buf.Add( ESyncEvent::CmdBatch, tid, time, HandleToU64( queue ));
 
-			for (uint j = 0; j < submit.signalSemaphoreCount; ++j) {
-				_signalSemaphores[ submit.pSignalSemaphores[j] ] = cmd.uid;
+				batch.batch.waitSemaphores		= buf.AddHandles( submit.pWaitSemaphores, submit.waitSemaphoreCount );
+				batch.batch.signalSemaphores	= buf.AddHandles( submit.pSignalSemaphores, submit.signalSemaphoreCount );
 			}
-			
-			cmd_submit.batches.push_back( cmd.uid );
-			cmd_signal.dependsOn.push_back( cmd.uid );
-
-			_globalSyncs.push_back( cmd );
-		}
-
-		_globalSyncs.push_back( cmd_submit );
-		
-		if ( fence )
-		{
-			_globalSyncs.push_back( cmd_signal );
-			_signalFences[ fence ] = { cmd_signal.uid };
-		}
+		});
 	}
 	
 /*
@@ -311,22 +756,13 @@ namespace VSA
 		VkQueue                                     queue,
 		VkResult                                    result)
 	{
-		if ( result != VK_SUCCESS )
-			return;
-
-		EXLOCK( _lock );
-		
-		if ( not _enabled )
+		if ( result != VK_SUCCESS or not _enabled.load( std::memory_order_relaxed ))
 			return;
 
-		QueueWaitIdle	cmd;
-		cmd.threadId	= _GetThreadID();
-		cmd.time		= _GetTimePoint();
-		cmd.dev			= _queues[queue].dev;
-		cmd.uid			= _GetUID();
-		cmd.queue		= queue;
-		
-		_globalSyncs.push_back( cmd );
+		_AddEvents( [&] (SyncEventBuffer &buf, ThreadID tid, const CallTime &time)
+		{
+			buf.Add( ESyncEvent::QueueWaitIdle, tid, time, HandleToU64( queue ));
+		});
 	}
 	
 /*
@@ -337,22 +773,14 @@ namespace VSA
 	void SyncAnalyzer::vki_DeviceWaitIdle(
 		VkDevice                                    device,
 		VkResult                                    result)
-	{
-		if ( result != VK_SUCCESS )
-			return;
-
-		EXLOCK( _lock );
-		
-		if ( not _enabled )
+	{
+		if ( result != VK_SUCCESS or not _enabled.load( std::memory_order_relaxed ))
 			return;
 
-		DeviceWaitIdle	cmd;
-		cmd.threadId	= _GetThreadID();
-		cmd.time		= _GetTimePoint();
-		cmd.dev			= device;
-		cmd.uid			= _GetUID();
-		
-		_globalSyncs.push_back( cmd );
+		_AddEvents( [&] (SyncEventBuffer &buf, ThreadID tid, const CallTime &time)
+		{
+			buf.Add( ESyncEvent::DeviceWaitIdle, tid, time, HandleToU64( device ));
+		});
 	}
 	
 /*
@@ -367,80 +795,102 @@ namespace VSA
 		VkFence                                     fence,
 		VkResult                                    result)
 	{
-		/*if ( result != VK_SUCCESS )
-			return;
-
-		EXLOCK( _lock );
-		
-		if ( not _enabled )
+		if ( result != VK_SUCCESS or not _enabled.load( std::memory_order_relaxed ))
 			return;
 
-		const auto	tid		= _GetThreadID();
-		const auto	time	= _GetTimePoint();
-		const auto	dev		= _queues[queue].dev;
-		
-		if ( fence )
-			_signalFences[ fence ].clear();
-
-		for (uint i = 0; i < bindInfoCount; ++i)
+		// has the same synchronization as submit, memory bindings are not recorded
+		_AddEvents( [&] (SyncEventBuffer &buf, ThreadID tid, const CallTime &time)
 		{
-			const auto&	submit = pBindInfo[i];
-
-			BindSparse		cmd;
-			cmd.threadId	= tid;
-			cmd.time		= time;
-			cmd.dev			= dev;
-			cmd.uid			= _GetUID();
-			cmd.queue		= queue;
-			cmd.fence		= fence;
-			cmd.signalSemaphores.assign( submit.pSignalSemaphores, submit.pSignalSemaphores + submit.signalSemaphoreCount );
-			cmd.waitSemaphores.assign( submit.pWaitSemaphores, submit.pWaitSemaphores + submit.waitSemaphoreCount );
-			
-			for (uint j = 0; j < submit.waitSemaphoreCount; ++j)
-			{
-				auto	iter = _signalSemaphores.find( submit.pWaitSemaphores[j] );
-				ASSERT( iter != _signalSemaphores.end() );
+			auto&	cmd = buf.Add( ESyncEvent::QueueSubmit, tid, time, HandleToU64( queue ));
+			cmd.flags				= ESyncEventFlags::BindSparse;
+			cmd.submit.fence		= HandleToU64( fence );
+			cmd.submit.batchCount	= bindInfoCount;
 
-				if ( iter != _signalSemaphores.end() )
-				{
-					cmd.waitDeps.push_back( iter->second );
-					_signalSemaphores.erase( iter );
-				}
-			}
+			for (uint i = 0; i < bindInfoCount; ++i)
+			{
+				const auto&	bind	= pBindInfo[i];
+				auto&		batch	= buf.Add( ESyncEvent::CmdBatch, tid, time, HandleToU64( queue ));
 
-			for (uint j = 0; j < submit.signalSemaphoreCount; ++j) {
-				_signalSemaphores[ submit.pSignalSemaphores[j] ] = cmd.uid;
+				batch.batch.waitSemaphores		= buf.AddHandles( bind.pWaitSemaphores, bind.waitSemaphoreCount );
+				batch.batch.signalSemaphores	= buf.AddHandles( bind.pSignalSemaphores, bind.signalSemaphoreCount );
 			}
+		});
+	}
+	
+/*
+=================================================
+	_AddDestroyEvent
+=================================================
+*/
+	void SyncAnalyzer::_AddDestroyEvent (uint64_t object)
+	{
+		if ( object == 0 or not _enabled.load( std::memory_order_relaxed ))
+			return;
 
-			if ( fence )
-				_signalFences[ fence ].push_back( cmd.uid );
+		_AddEvents( [&] (SyncEventBuffer &buf, ThreadID tid, const CallTime &time)
+		{
+			buf.Add( ESyncEvent::DestroyObject, tid, time, object );
+		});
+	}
 
-			_globalSyncs.push_back( cmd );
-		}*/
+/*
+=================================================
+	vki_DestroyFence
+=================================================
+*/
+	void SyncAnalyzer::vki_DestroyFence(
+		VkDevice                                    ,
+		VkFence                                     fence,
+		const VkAllocationCallbacks*                )
+	{
+		_AddDestroyEvent( HandleToU64( fence ));
 	}
 	
+/*
+=================================================
+	vki_DestroySemaphore
+=================================================
+*/
+	void SyncAnalyzer::vki_DestroySemaphore(
+		VkDevice                                    ,
+		VkSemaphore                                 semaphore,
+		const VkAllocationCallbacks*                )
+	{
+		_AddDestroyEvent( HandleToU64( semaphore ));
+	}
+	
+/*
+=================================================
+	vki_DestroySwapchainKHR
+=================================================
+*/
+	void SyncAnalyzer::vki_DestroySwapchainKHR(
+		VkDevice                                    ,
+		VkSwapchainKHR                              swapchain,
+		const VkAllocationCallbacks*                )
+	{
+		_AddDestroyEvent( HandleToU64( swapchain ));
+	}
+
 /*
 =================================================
 	vki_ResetFences
 =================================================
 */
 	void SyncAnalyzer::vki_ResetFences(
-		VkDevice                                    ,
+		VkDevice                                    device,
 		uint32_t                                    fenceCount,
 		const VkFence*                              pFences,
 		VkResult                                    result)
 	{
-		if ( result != VK_SUCCESS )
-			return;
-
-		EXLOCK( _lock );
-		
-		if ( not _enabled )
+		if ( result != VK_SUCCESS or not _enabled.load( std::memory_order_relaxed ))
 			return;
 
-		for (uint i = 0; i < fenceCount; ++i) {
-			_signalFences.erase( pFences[i] );
-		}
+		_AddEvents( [&] (SyncEventBuffer &buf, ThreadID tid, const CallTime &time)
+		{
+			auto&	cmd = buf.Add( ESyncEvent::ResetFences, tid, time, HandleToU64( device ));
+			cmd.fences.fences = buf.AddHandles( pFences, fenceCount );
+		});
 	}
 	
 /*
@@ -453,29 +903,15 @@ namespace VSA
 		VkFence                                     fence,
 		VkResult                                    result)
 	{
-		if ( not (result == VK_SUCCESS or result == VK_TIMEOUT) )
-			return;
-
-		EXLOCK( _lock );
-		
-		if ( not _enabled )
+		if ( not (result == VK_SUCCESS or result == VK_TIMEOUT) or not _enabled.load( std::memory_order_relaxed ))
 			return;
 
-		WaitForFences	cmd;
-		cmd.threadId	= _GetThreadID();
-		cmd.time		= _GetTimePoint();
-		cmd.dev			= device;
-		cmd.uid			= _GetUID();
-		cmd.waitForAll	= true;
-		cmd.timeout		= result == VK_TIMEOUT;
-		cmd.fences.push_back( fence );
-		
+		_AddEvents( [&] (SyncEventBuffer &buf, ThreadID tid, const CallTime &time)
 		{
-			auto& arr = _signalFences[ fence ];
-			cmd.fenceDeps.insert( cmd.fenceDeps.end(), arr.begin(), arr.end() );
-		}
-
-		_globalSyncs.push_back( cmd );
+			auto&	cmd = buf.Add( ESyncEvent::WaitForFences, tid, time, HandleToU64( device ));
+			cmd.flags			= ESyncEventFlags::WaitAll | (result == VK_TIMEOUT ? ESyncEventFlags::Timeout : ESyncEventFlags::None);
+			cmd.fences.fences	= buf.AddHandles( &fence, 1 );
+		});
 	}
 
 /*
@@ -491,30 +927,15 @@ namespace VSA
 		uint64_t                                    ,
 		VkResult                                    result)
 	{
-		if ( not (result == VK_SUCCESS or result == VK_TIMEOUT) )
-			return;
-
-		EXLOCK( _lock );
-		
-		if ( not _enabled )
+		if ( not (result == VK_SUCCESS or result == VK_TIMEOUT) or not _enabled.load( std::memory_order_relaxed ))
 			return;
 
-		WaitForFences	cmd;
-		cmd.threadId	= _GetThreadID();
-		cmd.time		= _GetTimePoint();
-		cmd.dev			= device;
-		cmd.uid			= _GetUID();
-		cmd.waitForAll	= waitAll;
-		cmd.timeout		= result == VK_TIMEOUT;
-		cmd.fences.assign( pFences, pFences + fenceCount );
-		
-		for (uint i = 0; i < fenceCount; ++i)
+		_AddEvents( [&] (SyncEventBuffer &buf, ThreadID tid, const CallTime &time)
 		{
-			auto& arr = _signalFences[ pFences[i] ];
-			cmd.fenceDeps.insert( cmd.fenceDeps.end(), arr.begin(), arr.end() );
-		}
-
-		_globalSyncs.push_back( cmd );
+			auto&	cmd = buf.Add( ESyncEvent::WaitForFences, tid, time, HandleToU64( device ));
+			cmd.flags			= (waitAll ? ESyncEventFlags::WaitAll : ESyncEventFlags::None) | (result == VK_TIMEOUT ? ESyncEventFlags::Timeout : ESyncEventFlags::None);
+			cmd.fences.fences	= buf.AddHandles( pFences, fenceCount );
+		});
 	}
 		
 /*
@@ -531,36 +952,16 @@ namespace VSA
 		uint32_t*                                   pImageIndex,
 		VkResult                                    result)
 	{
-		if ( not (result == VK_SUCCESS or result == VK_TIMEOUT) )
+		if ( not (result == VK_SUCCESS or result == VK_TIMEOUT) or not _enabled.load( std::memory_order_relaxed ))
 			return;
 
-		EXLOCK( _lock );
-		
-		if ( not _enabled )
-			return;
-
-		AcquireImage	cmd;
-		cmd.threadId	= _GetThreadID();
-		cmd.time		= _GetTimePoint();
-		cmd.dev			= device;
-		cmd.uid			= _GetUID();
-		cmd.swapchain	= swapchain;
-		cmd.sem			= semaphore;
-		cmd.fence		= fence;
-
-		if ( semaphore )
-			_signalSemaphores[ semaphore ] = cmd.uid;
-
-		if ( fence )
-			_signalFences[ fence ].push_back( cmd.uid );
-
+		_AddEvents( [&] (SyncEventBuffer &buf, ThreadID tid, const CallTime &time)
 		{
-			auto&	sw = _swapchains[ swapchain ];
-			sw.resize( Max( sw.size(), *pImageIndex + 1 ));
-			sw[ *pImageIndex ] = cmd.uid;
-		}
-
-		_globalSyncs.push_back( cmd );
+			auto&	cmd = buf.Add( ESyncEvent::AcquireImage, tid, time, HandleToU64( swapchain ));
+			cmd.acquire.semaphore	= HandleToU64( semaphore );
+			cmd.acquire.fence		= HandleToU64( fence );
+			cmd.acquire.imageIndex	= *pImageIndex;
+		});
 	}
 		
 /*
@@ -574,36 +975,16 @@ namespace VSA
 		uint32_t*                                   pImageIndex,
 		VkResult                                    result)
 	{
-		if ( not (result == VK_SUCCESS or result == VK_TIMEOUT) )
-			return;
-
-		EXLOCK( _lock );
-		
-		if ( not _enabled )
+		if ( not (result == VK_SUCCESS or result == VK_TIMEOUT) or not _enabled.load( std::memory_order_relaxed ))
 			return;
 
-		AcquireImage	cmd;
-		cmd.threadId	= _GetThreadID();
-		cmd.time		= _GetTimePoint();
-		cmd.dev			= device;
-		cmd.uid			= _GetUID();
-		cmd.swapchain	= pAcquireInfo->swapchain;
-		cmd.sem			= pAcquireInfo->semaphore;
-		cmd.fence		= pAcquireInfo->fence;
-		
-		if ( pAcquireInfo->semaphore )
-			_signalSemaphores[ pAcquireInfo->semaphore ] = cmd.uid;
-
-		if ( pAcquireInfo->fence )
-			_signalFences[ pAcquireInfo->fence ].push_back( cmd.uid );
-		
+		_AddEvents( [&] (SyncEventBuffer &buf, ThreadID tid, const CallTime &time)
 		{
-			auto&	sw = _swapchains[ pAcquireInfo->swapchain ];
-			sw.resize( Max( sw.size(), *pImageIndex + 1 ));
-			sw[ *pImageIndex ] = cmd.uid;
-		}
-
-		_globalSyncs.push_back( cmd );
+			auto&	cmd = buf.Add( ESyncEvent::AcquireImage, tid, time, HandleToU64( pAcquireInfo->swapchain ));
+			cmd.acquire.semaphore	= HandleToU64( pAcquireInfo->semaphore );
+			cmd.acquire.fence		= HandleToU64( pAcquireInfo->fence );
+			cmd.acquire.imageIndex	= *pImageIndex;
+		});
 	}
 	
 /*
@@ -616,46 +997,20 @@ namespace VSA
 		const VkPresentInfoKHR*                     pPresentInfo,
 		VkResult                                    result)
 	{
-		if ( not (result == VK_SUCCESS or result == VK_SUBOPTIMAL_KHR) )
-			return;
-
-		EXLOCK( _lock );
-		
-		if ( not _enabled )
+		if ( not (result == VK_SUCCESS or result == VK_SUBOPTIMAL_KHR) or not _enabled.load( std::memory_order_relaxed ))
 			return;
 
-		QueuePresent	cmd;
-		cmd.threadId	= _GetThreadID();
-		cmd.time		= _GetTimePoint();
-		cmd.dev			= _queues[queue].dev;
-		cmd.uid			= _GetUID();
-		cmd.queue		= queue;
-		cmd.waitSemaphores.assign( pPresentInfo->pWaitSemaphores, pPresentInfo->pWaitSemaphores + pPresentInfo->waitSemaphoreCount );
-		
-		for (uint j = 0; j < pPresentInfo->waitSemaphoreCount; ++j)
-		{
-			auto	iter = _signalSemaphores.find( pPresentInfo->pWaitSemaphores[j] );
-			ASSERT( iter != _signalSemaphores.end() );
-
-			if ( iter != _signalSemaphores.end() )
-			{
-				cmd.waitDeps.push_back( iter->second );
-				_signalSemaphores.erase( iter );
-			}
-		}
-
-		for (uint i = 0; i < pPresentInfo->swapchainCount; ++i)
+		_AddEvents( [&] (SyncEventBuffer &buf, ThreadID tid, const CallTime &time)
 		{
-			auto	iter = _swapchains.find( pPresentInfo->pSwapchains[i] );
-			ASSERT( iter != _swapchains.end() );
+			auto&	cmd = buf.Add( ESyncEvent::QueuePresent, tid, time, HandleToU64( queue ));
+			cmd.present.waitSemaphores	= buf.AddHandles( pPresentInfo->pWaitSemaphores, pPresentInfo->waitSemaphoreCount );
+			cmd.present.swapchains		= PoolRange{ uint(buf.handles.size()), pPresentInfo->swapchainCount };
 
-			if ( iter != _swapchains.end() and pPresentInfo->pImageIndices[i] < iter->second.size() )
-			{
-				cmd.swapchains.emplace_back( pPresentInfo->pSwapchains[i], iter->second[ pPresentInfo->pImageIndices[i] ] );
+			for (uint i = 0; i < pPresentInfo->swapchainCount; ++i) {
+				buf.handles.push_back( HandleToU64( pPresentInfo->pSwapchains[i] ));
+				buf.handles.push_back( pPresentInfo->pImageIndices[i] );
 			}
-		}
-
-		_globalSyncs.push_back( cmd );
+		});
 	}
 
 /*
@@ -670,6 +1025,7 @@ namespace VSA
 	{
 		if ( pNameInfo and pNameInfo->objectType == VK_DEBUG_REPORT_OBJECT_TYPE_QUEUE_EXT )
 		{
+			EXLOCK( _lock );
 			_queues[ VkQueue(pNameInfo->object) ].name = pNameInfo->pObjectName ? String(pNameInfo->pObjectName) : "";
 		}
 	}
@@ -686,459 +1042,10 @@ namespace VSA
 	{
 		if ( pNameInfo and pNameInfo->objectType == VK_OBJECT_TYPE_QUEUE )
 		{
+			EXLOCK( _lock );
 			_queues[ VkQueue(pNameInfo->objectHandle) ].name = pNameInfo->pObjectName ? String(pNameInfo->pObjectName) : "";
 		}
 	}
 //-----------------------------------------------------------------------------
 
-	
-/*
-=================================================
-	ColToStr
-=================================================
-*/
-	ND_ inline String  ColToStr (RGBA8u col)
-	{
-		uint	val = (uint(col.r) << 16) | (uint(col.g) << 8) | uint(col.b);
-		String	str = ToString<16>( val );
-
-		for (; str.length() < 6;) {
-			str.insert( str.begin(), '0' );
-		}
-		return str;
-	}
-	
-/*
-=================================================
-	_QueueName
-=================================================
-*/
-	String  SyncAnalyzer::_QueueName (VkQueue q) const
-	{
-		auto	iter = _queues.find( q );
-		
-		if ( iter != _queues.end() )
-			return iter->second.name;
-		
-		return ToString( uint64_t(q) );
-	}
-	
-/*
-=================================================
-	_ThreadName
-=================================================
-*/
-	String  SyncAnalyzer::_ThreadName (ThreadID tid) const
-	{
-		auto	iter = _threadNames.find( tid );
-		
-		if ( iter != _threadNames.end() )
-			return iter->second;
-
-		return ToString( uint(tid) );
-	}
-//-----------------------------------------------------------------------------
-
-
-/*
-=================================================
-	V1
-=================================================
-*/
-	String  SyncAnalyzer::V1::_ToCpuNodeName (UID id)
-	{
-		return "cn_"s << ToString( uint(id) );
-	}
-
-	String  SyncAnalyzer::V1::_ToGpuNodeName (UID id)
-	{
-		return "gn_"s << ToString( uint(id) );
-	}
-	
-	String  SyncAnalyzer::V1::_ToThreadNodeName (ThreadID id)
-	{
-		return "tid_"s << ToString( uint(id) );
-	}
-	
-	String  SyncAnalyzer::V1::_ToQueueNodeName (VkQueue id)
-	{
-		return "queue_"s << ToString( uint64_t(id) );
-	}
-
-	String  SyncAnalyzer::V1::_ToNodeStyle (StringView name, const NodeStyle &style)
-	{
-		return String()
-			<< " [label=\"" << name << '"'
-			<< ", fontcolor=\"#" << ColToStr( style.labelColor ) << '"'
-			<< (style.fontSize ? ", fontsize="s << ToString( style.fontSize ) : "")
-			<< ", fillcolor=\"#" << ColToStr( style.bgColor ) << '"'
-			<< ", style=filled];\n";
-	}
-	
-	String  SyncAnalyzer::V1::_AcquirePresentNodeStyle (StringView name)
-	{
-		NodeStyle	style;
-		style.bgColor		= HtmlColor::Lime;
-		style.labelColor	= HtmlColor::Black;
-		return V1::_ToNodeStyle( name, style );
-	}
-
-	String  SyncAnalyzer::V1::_WaitOnHostNodeStyle (StringView name)
-	{
-		NodeStyle	style;
-		style.bgColor		= HtmlColor::Red;
-		style.labelColor	= HtmlColor::White;
-		return V1::_ToNodeStyle( name, style );
-	}
-
-	String  SyncAnalyzer::V1::_SubmitNodeStyle (StringView name)
-	{
-		NodeStyle	style;
-		style.bgColor		= HtmlColor::Blue;
-		style.labelColor	= HtmlColor::White;
-		return V1::_ToNodeStyle( name, style );
-	}
-
-	String  SyncAnalyzer::V1::_CmdBatchNodeStyle (StringView name)
-	{
-		NodeStyle	style;
-		style.bgColor		= HtmlColor::DarkSlateGray;
-		style.labelColor	= HtmlColor::Gainsboro;
-		return V1::_ToNodeStyle( name, style );
-	}
-
-	String  SyncAnalyzer::V1::_FenceNodeStyle (StringView name)
-	{
-		NodeStyle	style;
-		style.bgColor		= HtmlColor::Gold;
-		style.labelColor	= HtmlColor::Black;
-		style.fontSize		= 8;
-		return String()
-			<< " [label=\"" << name << '"'
-			<< ", fontcolor=\"#" << ColToStr( style.labelColor ) << '"'
-			<< (style.fontSize ? ", fontsize="s << ToString( style.fontSize ) : "")
-			<< ", fillcolor=\"#" << ColToStr( style.bgColor ) << '"'
-			<< ", style=filled"
-			<< ", margin=0, nojustify=true];\n";
-	}
-
-	String  SyncAnalyzer::V1::_MakeSemaphoreEdge (UID from, UID to)
-	{
-		return V1::_ToGpuNodeName( from ) << ":e -> " << V1::_ToGpuNodeName( to ) << ":w [color=\"#" << ColToStr( HtmlColor::Orange ) << "\"];\n";
-	}
-	
-	String  SyncAnalyzer::V1::_MakeSwapchainEdge (UID from, UID to)
-	{
-		return V1::_ToGpuNodeName( from ) << ":e -> " << V1::_ToGpuNodeName( to ) << ":w [color=\"#" << ColToStr( HtmlColor::Lime ) << "\"];\n";
-	}
-
-	String  SyncAnalyzer::V1::_MakeCpuToGpuSyncEdge (UID fromCpu, UID toGpu)
-	{
-		return V1::_ToCpuNodeName( fromCpu ) << " -> " << V1::_ToGpuNodeName( toGpu ) << " [color=\"#" << ColToStr( HtmlColor::DeepSkyBlue ) << "\", minlen=2];\n";
-	}
-	
-	String  SyncAnalyzer::V1::_MakeGpuToCpuSyncEdge (UID fromGpu, UID toCpu)
-	{
-		return V1::_ToGpuNodeName( fromGpu ) << " -> " << V1::_ToCpuNodeName( toCpu ) << " [color=\"#" << ColToStr( HtmlColor::Red ) << "\", minlen=2];\n";
-	}
-	
-	String  SyncAnalyzer::V1::_MakeStrongHiddenEdge (StringView from, StringView to)
-	{
-		return String(from) << " -> " << to << " [minlen=0, style=invis];\n";
-	}
-
-/*
-=================================================
-	_SaveDotFile_v1
-=================================================
-*/
-	bool SyncAnalyzer::_SaveDotFile_v1 () const
-	{
-		String	str;
-		str << "digraph SyncAnalyzer {\n"
-			<< "	rankdir = LR;\n"
-			<< "	bgcolor = black;\n"
-			<< "	compound=true;\n\n";
-
-		String	rank_decl;
-		String	rank;
-		String	deps;
-		String	rank_names;
-
-		rank_decl << "\"init\" -> ";
-		auto	add_rank = [&rank_decl, &rank, last = TimePoint{~0u}] (TimePoint time) mutable
-		{
-			if ( last != time ) {
-				rank_decl << '"' << ToString( uint(time) ) << "\" -> ";
-				rank << (rank.empty() ? "" : "\t}\n")
-						<< "\t{\n"
-						<< "\t	rank = same; \"" << ToString( uint(time) ) << "\";\n";
-				last = time;
-			}
-		};
-
-		HashMap<ThreadID, UID>	active_threads;
-		auto	make_cpu_timeline = [&active_threads] (UID id, ThreadID tid)
-		{
-			String	str;
-			auto	iter = active_threads.find( tid );
-			if ( iter != active_threads.end() ) {
-				str << V1::_ToCpuNodeName( iter->second ) << ":e -> " << V1::_ToCpuNodeName( id ) << ":w";
-			} else {
-				str << V1::_ToThreadNodeName( tid ) << ":e -> " << V1::_ToCpuNodeName( id ) << ":w";
-			}
-			active_threads.insert_or_assign( tid, id );
-			return str << " [color=\"#" << ColToStr( HtmlColor::DeepSkyBlue ) << "\", style=dotted, penwidth=2];\n";
-		};
-
-		HashMap<VkQueue, UID>	active_queues;
-		auto	make_gpu_timeline = [&active_queues] (UID id, VkQueue queue)
-		{
-			String	str;
-			auto	iter = active_queues.find( queue );
-			if ( iter != active_queues.end() ) {
-				str << V1::_ToGpuNodeName( iter->second ) << ":e -> " << V1::_ToGpuNodeName( id ) << ":w";
-			} else {
-				str << V1::_ToQueueNodeName( queue ) << ":e -> " << V1::_ToGpuNodeName( id ) << ":w";
-			}
-			active_queues.insert_or_assign( queue, id );
-			return str << " [color=\"#" << ColToStr( HtmlColor::DarkGreen ) << "\", style=dotted, penwidth=2];\n";
-		};
-			
-		for (auto& sync : _globalSyncs)
-		{
-			Visit( sync,
-				[&] (const QueueSubmit& sync) {
-					add_rank( sync.time );
-					rank<< "\t\t" << V1::_ToCpuNodeName( sync.uid ) << V1::_SubmitNodeStyle( "Submit" );
-					deps<< "\t" << make_cpu_timeline( sync.uid, sync.threadId );
-
-					for (auto& batch : sync.batches) {
-						deps << "\t" << V1::_MakeCpuToGpuSyncEdge( sync.uid, batch );
-					}
-				},
-
-				[&] (const CmdBatch& sync) {
-					add_rank( sync.time );
-					rank<< "\t\t" << V1::_ToGpuNodeName( sync.uid ) << V1::_CmdBatchNodeStyle( "CmdBatch" );
-					deps<< "\t" << make_gpu_timeline( sync.uid, sync.queue );
-
-					for (auto& sem : sync.waitDeps) {
-						deps << "\t" << V1::_MakeSemaphoreEdge( sem, sync.uid );
-					}
-				},
-
-				[&] (const FenceSignal& sync) {
-					add_rank( sync.time );
-					rank<< "\t\t" << V1::_ToGpuNodeName( sync.uid ) << V1::_FenceNodeStyle( "Fence" );
-
-					for (auto& batch : sync.dependsOn) {
-						deps << "\t" << V1::_MakeSemaphoreEdge( batch, sync.uid );
-					}
-				},
-
-				[&] (const QueueWaitIdle& sync) {
-					add_rank( sync.time );
-					rank<< "\t\t" << V1::_ToCpuNodeName( sync.uid ) << V1::_WaitOnHostNodeStyle( "Wait" )
-						<< "\t\t" << V1::_ToGpuNodeName( sync.uid ) << V1::_WaitOnHostNodeStyle( "Wait" );
-					deps<< "\t" << make_cpu_timeline( sync.uid, sync.threadId )
-						<< "\t" << make_gpu_timeline( sync.uid, sync.queue )
-						<< "\t" << V1::_MakeGpuToCpuSyncEdge( sync.uid, sync.uid );
-				},
-
-				[&] (const DeviceWaitIdle& sync) {
-					add_rank( sync.time );
-					rank<< "\t\t" << V1::_ToCpuNodeName( sync.uid ) << V1::_WaitOnHostNodeStyle( "Wait" );
-					deps<< "\t" << make_cpu_timeline( sync.uid, sync.threadId );
-					// TODO: insert node to all queues
-				},
-
-				[&] (const WaitForFences& sync) {
-					if ( sync.timeout )
-						return;
-
-					add_rank( sync.time );
-					rank<< "\t\t" << V1::_ToCpuNodeName( sync.uid ) << V1::_WaitOnHostNodeStyle( "Wait" );
-					deps<< "\t" << make_cpu_timeline( sync.uid, sync.threadId );
-
-					for (auto& fence : sync.fenceDeps) {
-						deps << "\t" << V1::_MakeGpuToCpuSyncEdge( fence, sync.uid );
-					}
-				},
-
-				[&] (const AcquireImage& sync) {
-					add_rank( sync.time );
-					rank<< "\t\t" << V1::_ToCpuNodeName( sync.uid ) << V1::_AcquirePresentNodeStyle( "Acquire" )
-						<< "\t\t" << V1::_ToGpuNodeName( sync.uid ) << V1::_AcquirePresentNodeStyle( "Acquire" );
-					deps<< "\t" << make_cpu_timeline( sync.uid, sync.threadId )
-						<< "\t" << V1::_MakeCpuToGpuSyncEdge( sync.uid, sync.uid );
-				},
-
-				[&] (const QueuePresent& sync) {
-					add_rank( sync.time );
-					rank<< "\t\t" << V1::_ToCpuNodeName( sync.uid ) << V1::_AcquirePresentNodeStyle( "Present" )
-						<< "\t\t" << V1::_ToGpuNodeName( sync.uid ) << V1::_AcquirePresentNodeStyle( "Present" );
-					deps<< "\t" << make_cpu_timeline( sync.uid, sync.threadId )
-						<< "\t" << make_gpu_timeline( sync.uid, sync.queue )
-						<< "\t" << V1::_MakeCpuToGpuSyncEdge( sync.uid, sync.uid );
-
-					for (auto&[sw, acq] : sync.swapchains) {
-						deps << "\t" << V1::_MakeSwapchainEdge( acq, sync.uid );
-					}
-					for (auto& sem : sync.waitDeps) {
-						deps << "\t" << V1::_MakeSemaphoreEdge( sem, sync.uid );
-					}
-				}
-			);
-		}
-
-		{
-			String	prev_thread;
-			for (auto& item : active_threads)
-			{
-				NodeStyle	style;
-				style.bgColor		= HtmlColor::Indigo;
-				style.labelColor	= HtmlColor::White;
-
-				String		curr = V1::_ToThreadNodeName( item.first );
-				rank_names << "\t\t" << curr << V1::_ToNodeStyle( _ThreadName( item.first ), style );
-
-				if ( prev_thread.size() )
-					deps << V1::_MakeStrongHiddenEdge( prev_thread, curr );
-
-				prev_thread = std::move(curr);
-			}
-		}{
-			String	prev_queue;
-			for (auto& item : active_queues)
-			{
-				NodeStyle	style;
-				style.bgColor		= HtmlColor::DarkSlateGray;
-				style.labelColor	= HtmlColor::Gainsboro;
-			
-				String		curr = V1::_ToQueueNodeName( item.first );
-				rank_names << "\t\t" << curr << V1::_ToNodeStyle( _QueueName( item.first ), style );
-			
-				if ( prev_queue.size() )
-					deps << V1::_MakeStrongHiddenEdge( prev_queue, curr );
-
-				prev_queue = std::move(curr);
-			}
-		}
-
-		if ( EndsWith( rank_decl, " -> " ) )
-			rank_decl.erase( rank_decl.size() - 4, 4 );
-
-		str	<< "	{\n"
-			<< "		node [shape=plaintext, fontname=\"helvetica\", fontsize=5, fontcolor=white];\n"
-			<< "		" << rank_decl << ";\n"
-			<< "	}\n\n"
-			<< "	{\n"
-			<< "		rank = same; \"init\";\n"
-			<< "		node [shape=rectangle, fontname=\"helvetica\", penwidth=0.0];\n"
-			<< "		edge [fontname=\"helvetica\", fontcolor=white, minlen=1];\n"
-			<<			rank_names
-			<< "	}\n\n"
-			<< "	node [shape=rectangle, fontname=\"helvetica\", penwidth=0.0];\n"
-			<< "	edge [fontname=\"helvetica\", fontcolor=white, minlen=1];\n"
-			<<		rank
-			<< "	}\n\n"
-			<<		deps
-			<< "}\n";
-
-		return _Visualize( str, "C:\\Projects\\sync_graph_v1.dot", "png" );
-	}
-//-----------------------------------------------------------------------------
-
-	
-/*
-=================================================
-	Execute
-=================================================
-*/
-	static bool Execute (StringView commands, uint timeoutMS)
-	{
-#	ifdef PLATFORM_WINDOWS
-		char	buf[MAX_PATH] = {};
-		::GetSystemDirectoryA( buf, UINT(CountOf(buf)) );
-		
-		String		command_line;
-		command_line << '"' << buf << "\\cmd.exe\" /C " << commands;
-
-		STARTUPINFOA			startup_info = {};
-		PROCESS_INFORMATION		proc_info	 = {};
-		
-		bool process_created = ::CreateProcessA(
-			NULL,
-			command_line.data(),
-			NULL,
-			NULL,
-			FALSE,
-			CREATE_NO_WINDOW,
-			NULL,
-			NULL,
-			OUT &startup_info,
-			OUT &proc_info
-		);
-
-		if ( not process_created )
-			return false;
-
-		if ( ::WaitForSingleObject( proc_info.hThread, timeoutMS ) != WAIT_OBJECT_0 )
-			return false;
-		
-		DWORD process_exit;
-		::GetExitCodeProcess( proc_info.hProcess, OUT &process_exit );
-
-		return true;
-#	else
-		return false;
-#	endif
-	}
-
-/*
-=================================================
-	_Visualize
-=================================================
-*/
-	bool SyncAnalyzer::_Visualize (StringView graph, StringView path, StringView format) const
-	{
-		namespace FS = std::filesystem;
-
-		const FS::path	filepath	{ path };
-		const FS::path	graph_path	= FS::path{filepath}.concat( "."s << format );
-
-		CHECK_ERR( filepath.extension() == ".dot" );
-		FS::create_directories( filepath.parent_path() );
-
-
-		// space in path is not supported
-		CHECK_ERR( path.find( ' ' ) == String::npos );
-
-		// save to '.dot' file
-		{
-			FileWStream		wfile{ path };
-			CHECK_ERR( wfile.IsOpen() );
-			CHECK_ERR( wfile.Write( graph ));
-
-			VSA_LOGI( String(VSA_LAYER_NAME) << ": Dot-file saved into '"s << path << "'" );
-		}
-
-		// generate graph
-		{
-			// delete previous version
-			if ( FS::exists( graph_path ) )
-			{
-				CHECK( FS::remove( graph_path ));
-				std::this_thread::sleep_for( std::chrono::milliseconds(1) );
-			}
-			
-			CHECK_ERR( Execute( "\""s << VSA_GRAPHVIZ_DOT_EXECUTABLE << "\" -T" << format << " -O " << path, 30'000 ));
-			
-			VSA_LOGI( String(VSA_LAYER_NAME) << ": Graph saved into '"s << graph_path.string() << "'" );
-		}
-
-		return true;
-	}
-
 }	// VSA
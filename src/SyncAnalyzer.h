@@ -4,13 +4,16 @@
 
 #include <thread>
 #include <mutex>
+#include <atomic>
 
 #include "stl/Containers/Ptr.h"
-#include "stl/Containers/Union.h"
 #include "stl/Containers/FixedArray.h"
-#include "stl/Math/Color.h"
+#include "stl/Algorithms/Hash.h"
 
 #include "src/IAnalyzer.h"
+#include "src/SyncEvents.h"
+#include "src/SyncTraceWriter.h"
+#include "src/CaptureExporter.h"
 
 namespace VSA
 {
@@ -23,70 +26,21 @@ namespace VSA
 	{
 	// types
 	private:
-		enum class ThreadID : uint {};
-		enum class TimePoint : uint {};
-		enum class UID : uint {};
-
-		struct BaseCpuSyncEvent {
-			VkDevice			dev			= VK_NULL_HANDLE;
-			ThreadID			threadId;
-			TimePoint			time;
-			UID					uid;
-		};
-
-		struct QueueSubmit : BaseCpuSyncEvent
-		{
-			Array<UID>			batches;
-		};
-
-		struct FenceSignal : BaseCpuSyncEvent
-		{
-			Array<UID>			dependsOn;
-			VkQueue				queue		= VK_NULL_HANDLE;
-			VkFence				fence		= VK_NULL_HANDLE;
-		};
-
-		struct CmdBatch : BaseCpuSyncEvent
-		{
-			VkQueue				queue		= VK_NULL_HANDLE;
-			Array<VkSemaphore>	signalSemaphores;
-			Array<VkSemaphore>	waitSemaphores;
-			Array<UID>			waitDeps;
-		};
-
-		struct QueueWaitIdle : BaseCpuSyncEvent
+		// events recorded by a single thread, lock is contended only by 'Start()' and 'Stop()'
+		struct ThreadEvents
 		{
-			VkQueue				queue		= VK_NULL_HANDLE;
+			std::mutex				guard;
+			ThreadID				threadId;
+			String					name;
+			std::atomic<bool>		retired	{false};	// set when thread exits, buffer is released after next merge
+			UniquePtr<EventStorage>	storage;			// swapped with empty storage in 'Stop()'
 		};
 
-		struct DeviceWaitIdle : BaseCpuSyncEvent
-		{
-		};
-
-		struct WaitForFences : BaseCpuSyncEvent
-		{
-			Array<UID>			fenceDeps;
-			Array<VkFence>		fences;
-			bool				waitForAll;
-			bool				timeout;
-		};
-
-		struct AcquireImage : BaseCpuSyncEvent
-		{
-			VkSwapchainKHR		swapchain	= VK_NULL_HANDLE;
-			VkSemaphore			sem			= VK_NULL_HANDLE;
-			VkFence				fence		= VK_NULL_HANDLE;
-		};
-
-		struct QueuePresent : BaseCpuSyncEvent
-		{
-			VkQueue					queue		= VK_NULL_HANDLE;
-			Array<VkSemaphore>		waitSemaphores;
-			Array<UID>				waitDeps;
-			Array<Pair< VkSwapchainKHR, UID >>	swapchains;
-		};
+		// thread local state, see '_GetThreadSlot()'
+		struct ThreadSlot;
 
-		using GlobalSyncs_t = Array< Union< QueueSubmit, CmdBatch, FenceSignal, QueueWaitIdle, DeviceWaitIdle, WaitForFences, AcquireImage, QueuePresent >>;
+		// events of a single frame in flight recorder mode
+		using FrameRing_t	= Array< UniquePtr<EventStorage> >;
 
 
 	private:
@@ -114,49 +68,49 @@ namespace VSA
 
 		using DeviceMap_t	= HashMap< VkDevice, DeviceInfo >;
 		using QueueMap_t	= HashMap< VkQueue, QueueInfo >;
-		using ThreadIDs_t	= HashMap< std::thread::id, ThreadID >;
-		using ThreadNames_t	= HashMap< ThreadID, String >;
-		using TimePoint_t	= std::chrono::high_resolution_clock::time_point;
-		
-		using SignalSemaphores_t= HashMap< VkSemaphore, UID >;
-		using SignalFences_t	= HashMap< VkFence, Array<UID> >;
-		using SwapchainDeps_t	= HashMap< VkSwapchainKHR, Array<UID> >;
-		
-		struct NodeStyle {
-			uint		fontSize	= 10;
-			RGBA8u		bgColor		= HtmlColor::White;
-			RGBA8u		labelColor	= HtmlColor::Black;
-		};
+		using ThreadEventsMap_t	= HashMap< ThreadID, SharedPtr<ThreadEvents> >;
 
 
 	// variables
 	private:
-		std::recursive_mutex	_lock;
+		std::recursive_mutex	_lock;				// protects devices and queues
 		VkInstance				_instance	= VK_NULL_HANDLE;
 		DeviceMap_t				_devices;
 		QueueMap_t				_queues;
-		GlobalSyncs_t			_globalSyncs;
-		SignalSemaphores_t		_signalSemaphores;
-		SignalFences_t			_signalFences;
-		SwapchainDeps_t			_swapchains;
+		CaptureArena_t			_captureArena;
+		SyncEventBuffer			_capture			{_captureArena};	// temporary buffer for the trace
+		CaptureExporter			_exporter;
 
-		ThreadIDs_t				_threadIds;
-		ThreadNames_t			_threadNames;
-		uint					_threadIdCounter	= 0;
-		bool					_enabled			= false;
-		TimePoint_t				_startTime;
-		uint					_uidCounter			= 0;
+		std::mutex				_threadEventsGuard;	// protects '_threadEvents' map, not the events
+		ThreadEventsMap_t		_threadEvents;
+		const uint				_recorderId;		// key for thread local cache
+
+		std::mutex				_frameGuard;		// protects frame ring and trace
+		FrameRing_t				_frameRing;			// empty if flight recorder is not used
+		size_t					_ringPos			= 0;	// slot for the next frame
+		size_t					_ringFrames			= 0;	// number of recorded frames
+		SyncTraceWriter			_trace;				// opened if events are streamed to the file
+
+		std::atomic<bool>		_enabled			{false};
+		std::atomic<uint64_t>	_startTime			{0};	// 'PerformanceCounter::Now()' at capture start, written before '_enabled'
 
 
 	// methods
 	public:
-		SyncAnalyzer () {}
+		SyncAnalyzer ();
 		
 		void OnCreateDevice (VkInstance, VkPhysicalDevice, VkDevice,
 							 PFN_vkGetInstanceProcAddr, PFN_vkGetDeviceProcAddr) override;
 
 		void Start () override;
 		void Stop () override;
+		void StartFlightRecorder (uint frames) override;
+		void Dump () override;
+		void EndFrame () override;
+
+		void vki_DestroyDevice(
+			VkDevice                                    device,
+			const VkAllocationCallbacks*                pAllocator);
 
 		void vki_GetDeviceQueue(
 			VkDevice                                    device,
@@ -191,6 +145,21 @@ namespace VSA
 			VkFence                                     fence,
 			VkResult                                    result);
 		
+		void vki_DestroyFence(
+			VkDevice                                    device,
+			VkFence                                     fence,
+			const VkAllocationCallbacks*                pAllocator);
+
+		void vki_DestroySemaphore(
+			VkDevice                                    device,
+			VkSemaphore                                 semaphore,
+			const VkAllocationCallbacks*                pAllocator);
+
+		void vki_DestroySwapchainKHR(
+			VkDevice                                    device,
+			VkSwapchainKHR                              swapchain,
+			const VkAllocationCallbacks*                pAllocator);
+
 		void vki_ResetFences(
 			VkDevice                                    device,
 			uint32_t                                    fenceCount,
@@ -241,39 +210,20 @@ namespace VSA
 			VkResult                                    result);
 
 	private:
-		ND_ ThreadID  _GetThreadID ();
-		ND_ TimePoint  _GetTimePoint ();
-		ND_ UID  _GetUID ();
+		ND_ static ThreadSlot&  _GetThreadSlot ();
+		ND_ CallTime  _GetCallTime () const;
+
+		ND_ ThreadEvents*  _GetThreadEvents ();
+		template <typename FN>
+			void  _AddEvents (FN &&fn);
+		void  _AddDestroyEvent (uint64_t object);
+		void  _MergeThreadEvents (INOUT SyncEventBuffer &dst);
+		void  _SwapThreadEvents (INOUT Array<UniquePtr<EventStorage>> &dst);
+		void  _CopyQueueNames (INOUT SyncEventBuffer &dst);
+		bool  _StopTrace ();
+		void  _LogMemoryUsage ();
 
-		ND_ String  _QueueName (VkQueue q) const;
-		ND_ String  _ThreadName (ThreadID tid) const;
-		
-		struct V1 {
-			static String  _ToCpuNodeName (UID id);
-			static String  _ToGpuNodeName (UID id);
-			static String  _ToThreadNodeName (ThreadID id);
-			static String  _ToQueueNodeName (VkQueue id);
-			static String  _ToNodeStyle (StringView name, const NodeStyle &style);
-			static String  _AcquirePresentNodeStyle (StringView name);
-			static String  _WaitOnHostNodeStyle (StringView name);
-			static String  _SubmitNodeStyle (StringView name);
-			static String  _CmdBatchNodeStyle (StringView name);
-			static String  _FenceNodeStyle (StringView name);
-			static String  _MakeSemaphoreEdge (UID from, UID to);
-			static String  _MakeSwapchainEdge (UID from, UID to);
-			static String  _MakeCpuToGpuSyncEdge (UID fromCpu, UID toGpu);
-			static String  _MakeGpuToCpuSyncEdge (UID fromGpu, UID toCpu);
-			static String  _MakeStrongHiddenEdge (StringView from, StringView to);
-		};
-
-		struct V2 {
-		};
-
-		bool _SaveDotFile_v1 () const;
-		bool _SaveDotFile_v2 () const;
 		void _Clear ();
-		
-		bool _Visualize (StringView graph, StringView filepath, StringView format) const;
 	};
 
 
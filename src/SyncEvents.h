@@ -0,0 +1,354 @@
+// Copyright (c) 2019,  Zhirnov Andrey. For more information see 'LICENSE'
+
+#pragma once
+
+#include "vulkan/vulkan.h"
+#include "stl/Algorithms/EnumUtils.h"
+#include "stl/Memory/LinearAllocator.h"
+
+namespace VSA
+{
+
+	enum class ThreadID : uint {};
+	enum class TimePoint : uint64_t {};	// nanoseconds since capture start
+	enum class UID : uint {};		// index of event in capture + 1, 0 is invalid
+
+	using CaptureArena_t = LinearAllocator<>;
+
+
+	//
+	// Call Time
+	//
+
+	struct CallTime
+	{
+		TimePoint	begin	{0};	// before calling the next layer
+		TimePoint	end		{0};	// after the next layer returns
+	};
+
+	template <typename T>
+	using ArenaArray = std::vector< T, StdLinearAllocator<T> >;
+
+	template <typename Key,
+			  typename Value,
+			  typename Hasher = std::hash<Key>>
+	using ArenaHashMap = std::unordered_map< Key, Value, Hasher, std::equal_to<Key>, StdLinearAllocator<std::pair<const Key, Value>> >;
+
+
+	//
+	// Sync Event Type
+	//
+
+	enum class ESyncEvent : uint8_t
+	{
+		Unknown	= 0,
+		QueueSubmit,		// object: queue,		followed by 'submit.batchCount' 'CmdBatch' events
+		CmdBatch,			// object: queue,		deps: semaphore signal events
+		QueueWaitIdle,		// object: queue
+		DeviceWaitIdle,		// object: device
+		ResetFences,		// object: device
+		WaitForFences,		// object: device,		deps: fence signal events
+		AcquireImage,		// object: swapchain
+		QueuePresent,		// object: queue,		deps: semaphore signal events
+		DestroyObject,		// object: semaphore, fence or swapchain, handle may be reused by a new object
+		_Count
+	};
+
+
+	//
+	// Sync Event Flags
+	//
+
+	enum class ESyncEventFlags : uint8_t
+	{
+		None		= 0,
+		WaitAll		= 1 << 0,
+		Timeout		= 1 << 1,
+		BindSparse	= 1 << 2,	// 'QueueSubmit' is recorded by 'vkQueueBindSparse'
+	};
+	VSA_BIT_OPERATORS( ESyncEventFlags );
+
+
+	//
+	// Pool Range
+	//
+
+	struct PoolRange
+	{
+		uint	offset	= 0;
+		uint	count	= 0;
+	};
+
+
+	//
+	// Sync Event
+	//
+
+	struct SyncEvent
+	{
+	// types
+		struct Submit {
+			uint64_t		fence;
+			uint			batchCount;
+		};
+
+		struct Batch {
+			PoolRange		waitSemaphores;		// in 'handles'
+			PoolRange		signalSemaphores;	// in 'handles'
+		};
+
+		struct Fences {
+			PoolRange		fences;				// in 'handles'
+		};
+
+		struct Acquire {
+			uint64_t		semaphore;
+			uint64_t		fence;
+			uint			imageIndex;
+		};
+
+		struct Present {
+			PoolRange		waitSemaphores;		// in 'handles'
+			PoolRange		swapchains;			// in 'handles', pairs of swapchain and image index
+			PoolRange		acquireDeps;		// in 'deps', acquire event for each swapchain
+		};
+
+	// variables
+		ESyncEvent			type		= ESyncEvent::Unknown;
+		ESyncEventFlags		flags		= ESyncEventFlags::None;
+		ThreadID			threadId	{0};
+		TimePoint			time		{0};			// call entry time
+		uint				duration	= 0;			// in nanoseconds, saturated
+		PoolRange			deps;					// in 'deps', filled when dependencies are resolved
+		uint64_t			object		= 0;
+		union {
+			Submit			submit;
+			Batch			batch;
+			Fences			fences;
+			Acquire			acquire;
+			Present			present;
+		};
+
+	// methods
+		SyncEvent () : acquire{} {}
+
+		ND_ TimePoint  EndTime () const		{ return TimePoint{ uint64_t(time) + duration }; }
+	};
+
+	STATIC_ASSERT( std::is_trivially_copyable_v< SyncEvent >);
+	STATIC_ASSERT( sizeof(SyncEvent) == 64 );
+
+
+	//
+	// Sync Event Buffer
+	//
+
+	struct SyncEventBuffer
+	{
+	// types
+		struct ObjectName {
+			uint64_t		object;		// queue handle or thread id
+			PoolRange		name;		// in 'strings'
+		};
+
+	// variables
+		ArenaArray< SyncEvent >		events;
+		ArenaArray< uint64_t >		handles;		// semaphores, fences, swapchains
+		ArenaArray< UID >			deps;			// resolved dependencies
+		ArenaArray< char >			strings;		// interned names
+		ArenaArray< ObjectName >	queueNames;
+		ArenaArray< ObjectName >	threadNames;
+
+	// methods
+		explicit SyncEventBuffer (CaptureArena_t &arena);
+
+		SyncEventBuffer (const SyncEventBuffer &) = delete;
+		SyncEventBuffer& operator = (const SyncEventBuffer &) = delete;
+
+		SyncEvent&  Add (ESyncEvent type, ThreadID tid, const CallTime &time, uint64_t object);
+
+		template <typename T>
+		ND_ PoolRange  AddHandles (const T* ptr, uint count);
+
+		ND_ uint64_t const*  GetHandles (const PoolRange &range) const	{ return handles.data() + range.offset; }
+		ND_ UID const*       GetDeps (const PoolRange &range) const		{ return deps.data() + range.offset; }
+
+		ND_ PoolRange   AddString (StringView str);
+		ND_ StringView  GetString (const PoolRange &range) const		{ return StringView{ strings.data() + range.offset, range.count }; }
+
+		void  SetQueueName (uint64_t queue, StringView name)			{ queueNames.push_back({ queue, AddString( name )}); }
+		void  SetThreadName (ThreadID tid, StringView name)				{ threadNames.push_back({ uint64_t(tid), AddString( name )}); }
+
+		ND_ StringView  FindQueueName (uint64_t queue) const			{ return _FindName( queueNames, queue ); }
+		ND_ StringView  FindThreadName (ThreadID tid) const				{ return _FindName( threadNames, uint64_t(tid) ); }
+
+		void  Append (const SyncEventBuffer &other);
+		void  Clear ();
+
+	private:
+		ND_ StringView  _FindName (const ArenaArray<ObjectName> &names, uint64_t object) const;
+	};
+
+
+	template <typename T>
+	ND_ inline uint64_t  HandleToU64 (T handle)
+	{
+		if constexpr( std::is_pointer_v<T> )
+			return uint64_t(reinterpret_cast<uintptr_t>( handle ));
+		else
+			return uint64_t(handle);
+	}
+
+	template <typename T>
+	ND_ inline T  U64ToHandle (uint64_t value)
+	{
+		if constexpr( std::is_pointer_v<T> )
+			return reinterpret_cast<T>( uintptr_t(value) );
+		else
+			return T(value);
+	}
+
+/*
+=================================================
+	constructor
+=================================================
+*/
+	inline SyncEventBuffer::SyncEventBuffer (CaptureArena_t &arena) :
+		events{ arena }, handles{ arena }, deps{ arena },
+		strings{ arena }, queueNames{ arena }, threadNames{ arena }
+	{}
+
+/*
+=================================================
+	Add
+=================================================
+*/
+	inline SyncEvent&  SyncEventBuffer::Add (ESyncEvent type, ThreadID tid, const CallTime &time, uint64_t object)
+	{
+		ASSERT( time.begin <= time.end );
+
+		auto&	ev = events.emplace_back();
+		ev.type		= type;
+		ev.threadId	= tid;
+		ev.time		= time.begin;
+		ev.duration	= uint(Min( uint64_t(time.end) - uint64_t(time.begin), uint64_t(uint(UMax)) ));
+		ev.object	= object;
+		return ev;
+	}
+
+/*
+=================================================
+	AddHandles
+=================================================
+*/
+	template <typename T>
+	inline PoolRange  SyncEventBuffer::AddHandles (const T* ptr, uint count)
+	{
+		PoolRange	range{ uint(handles.size()), count };
+
+		for (uint i = 0; i < count; ++i) {
+			handles.push_back( HandleToU64( ptr[i] ));
+		}
+		return range;
+	}
+
+/*
+=================================================
+	AddString
+=================================================
+*/
+	inline PoolRange  SyncEventBuffer::AddString (StringView str)
+	{
+		for (auto* names : {&queueNames, &threadNames})
+		{
+			for (auto& item : *names) {
+				if ( GetString( item.name ) == str )
+					return item.name;
+			}
+		}
+
+		PoolRange	range{ uint(strings.size()), uint(str.size()) };
+		strings.insert( strings.end(), str.begin(), str.end() );
+		return range;
+	}
+
+/*
+=================================================
+	_FindName
+=================================================
+*/
+	inline StringView  SyncEventBuffer::_FindName (const ArenaArray<ObjectName> &names, uint64_t object) const
+	{
+		for (auto& item : names) {
+			if ( item.object == object )
+				return GetString( item.name );
+		}
+		return {};
+	}
+
+/*
+=================================================
+	Append
+----
+	copy events and rebase handle ranges,
+	resolved dependencies and names are not copied.
+=================================================
+*/
+	inline void  SyncEventBuffer::Append (const SyncEventBuffer &other)
+	{
+		const uint	base	= uint(handles.size());
+		const auto	Rebase	= [base] (INOUT PoolRange &range) { range.offset += base; };
+
+		handles.insert( handles.end(), other.handles.begin(), other.handles.end() );
+		events.reserve( events.size() + other.events.size() );
+
+		for (auto ev : other.events)
+		{
+			ev.deps = PoolRange{};
+
+			switch ( ev.type )
+			{
+				case ESyncEvent::CmdBatch :
+					Rebase( INOUT ev.batch.waitSemaphores );
+					Rebase( INOUT ev.batch.signalSemaphores );
+					break;
+
+				case ESyncEvent::ResetFences :
+				case ESyncEvent::WaitForFences :
+					Rebase( INOUT ev.fences.fences );
+					break;
+
+				case ESyncEvent::QueuePresent :
+					Rebase( INOUT ev.present.waitSemaphores );
+					Rebase( INOUT ev.present.swapchains );
+					ev.present.acquireDeps = PoolRange{};
+					break;
+
+				default :
+					break;
+			}
+			events.push_back( ev );
+		}
+	}
+
+/*
+=================================================
+	Clear
+----
+	memory is returned to the arena only when the arena is discarded
+=================================================
+*/
+	inline void  SyncEventBuffer::Clear ()
+	{
+		const auto	Reset = [] (auto& arr) { arr = std::remove_reference_t<decltype(arr)>{ arr.get_allocator() }; };
+
+		Reset( events );
+		Reset( handles );
+		Reset( deps );
+		Reset( strings );
+		Reset( queueNames );
+		Reset( threadNames );
+	}
+
+
+}	// VSA
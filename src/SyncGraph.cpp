@@ -0,0 +1,779 @@
+// Copyright (c) 2019,  Zhirnov Andrey. For more information see 'LICENSE'
+
+#include "src/SyncGraph.h"
+#include "stl/Algorithms/StringUtils.h"
+#include "stl/Containers/ArrayView.h"
+#include "stl/Math/Color.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+
+namespace VSA
+{
+namespace SyncGraph
+{
+namespace
+{
+	struct SwapchainImage
+	{
+		uint64_t	swapchain;
+		uint64_t	index;
+
+		ND_ bool  operator == (const SwapchainImage &rhs) const	{ return swapchain == rhs.swapchain and index == rhs.index; }
+	};
+
+	struct SwapchainImageHash {
+		ND_ size_t  operator () (const SwapchainImage &x) const	{ return size_t(HashOf( x.swapchain ) + HashOf( x.index )); }
+	};
+
+	using SignalSemaphores_t= ArenaHashMap< uint64_t, UID >;			// semaphore to signal event
+	using SignalFences_t	= ArenaHashMap< uint64_t, UID >;			// fence to signal event
+	using SwapchainDeps_t	= ArenaHashMap< SwapchainImage, UID, SwapchainImageHash >;	// swapchain image to acquire event
+		
+	struct NodeStyle {
+		uint		fontSize	= 10;
+		RGBA8u		bgColor		= HtmlColor::White;
+		RGBA8u		labelColor	= HtmlColor::Black;
+	};
+
+	struct CpuNode		{ UID id; };
+	struct GpuNode		{ UID id; };
+	struct ThreadNode	{ ThreadID id; };
+	struct QueueNode	{ uint64_t id; };
+	struct HexColor		{ RGBA8u col; };
+
+
+	//
+	// Dot Stream
+	//
+	// Buffered text output to the stream, numbers and colors are formatted
+	// into the buffer, so writing a node or an edge doesn't allocate memory.
+	//
+	class DotStream
+	{
+	// variables
+	private:
+		WStream &		_stream;
+		size_t			_size		= 0;
+		bool			_failed		= false;
+		char			_buffer [16u << 10];
+
+
+	// methods
+	public:
+		explicit DotStream (WStream &stream) : _stream{stream} {}
+
+		DotStream (const DotStream &) = delete;
+		DotStream&  operator = (const DotStream &) = delete;
+
+		DotStream&  operator << (StringView str);
+		DotStream&  operator << (const char* str)	{ return *this << StringView{str}; }
+		DotStream&  operator << (char c);
+		DotStream&  operator << (uint64_t value);
+		DotStream&  operator << (HexColor col);
+		DotStream&  operator << (CpuNode node)		{ return *this << "cn_" << uint64_t(node.id); }
+		DotStream&  operator << (GpuNode node)		{ return *this << "gn_" << uint64_t(node.id); }
+		DotStream&  operator << (ThreadNode node)	{ return *this << "tid_" << uint64_t(node.id); }
+		DotStream&  operator << (QueueNode node)	{ return *this << "queue_" << node.id; }
+
+		ND_ bool  Flush ();
+	};
+
+
+	//
+	// Dot Timelines
+	//
+	struct DotTimelines
+	{
+		HashMap< ThreadID, UID >	threads;	// last event on the thread
+		HashMap< uint64_t, UID >	queues;		// last event on the queue
+	};
+
+	enum class EDotSection
+	{
+		RankDecl,
+		Rank,
+		Deps,
+	};
+
+	struct V1 {
+		static void  _NodeStyle (DotStream &out, StringView name, const NodeStyle &style);
+		static void  _AcquirePresentNodeStyle (DotStream &out, StringView name);
+		static void  _WaitOnHostNodeStyle (DotStream &out, StringView name);
+		static void  _SubmitNodeStyle (DotStream &out, StringView name);
+		static void  _CmdBatchNodeStyle (DotStream &out, StringView name);
+		static void  _FenceNodeStyle (DotStream &out, StringView name);
+		static void  _SemaphoreEdge (DotStream &out, UID from, UID to);
+		static void  _SwapchainEdge (DotStream &out, UID from, UID to);
+		static void  _CpuToGpuSyncEdge (DotStream &out, UID fromCpu, UID toGpu);
+		static void  _GpuToCpuSyncEdge (DotStream &out, UID fromGpu, UID toCpu);
+		static void  _WriteSection (DotStream &out, const SyncEventBuffer &capture, EDotSection section, OUT DotTimelines &timelines);
+	};
+
+}	// namespace
+//-----------------------------------------------------------------------------
+
+
+	
+/*
+=================================================
+	SortEvents
+----
+	events from one thread are already sorted, stable sort keeps this order,
+	so the submit and its batches stay together
+=================================================
+*/
+	void  SortEvents (INOUT SyncEventBuffer &capture)
+	{
+		std::stable_sort( capture.events.begin(), capture.events.end(),
+						  [] (auto& lhs, auto& rhs) { return lhs.time < rhs.time; });
+	}
+
+/*
+=================================================
+	ResolveDependencies
+----
+	replays merged events in time order and builds
+	dependencies between host and device sync points.
+=================================================
+*/
+	void  ResolveDependencies (INOUT SyncEventBuffer &capture, CaptureArena_t &tempArena)
+	{
+		SignalSemaphores_t	signal_semaphores	{ tempArena };
+		SignalFences_t		signal_fences		{ tempArena };
+		SwapchainDeps_t		swapchains			{ tempArena };
+		auto&				deps				= capture.deps;
+
+		const auto	WaitSemaphores = [&] (const PoolRange &range)
+		{
+			const uint64_t*	sems = capture.GetHandles( range );
+
+			for (uint i = 0; i < range.count; ++i)
+			{
+				auto	iter = signal_semaphores.find( sems[i] );
+				if ( iter != signal_semaphores.end() )
+				{
+					deps.push_back( iter->second );
+					signal_semaphores.erase( iter );
+				}
+			}
+		};
+
+		const auto	EndDeps = [&deps] (uint first) {
+			return PoolRange{ first, uint(deps.size()) - first };
+		};
+
+		for (size_t i = 0; i < capture.events.size(); ++i)
+		{
+			auto&		ev			= capture.events[i];
+			const UID	uid			{ uint(i + 1) };
+			const uint	first_dep	= uint(deps.size());
+
+			switch ( ev.type )
+			{
+				case ESyncEvent::QueueSubmit :
+				{
+					// 'uid' is used for fence signal too, fence depends on all batches
+					if ( ev.submit.fence )
+						signal_fences[ ev.submit.fence ] = uid;
+					break;
+				}
+				case ESyncEvent::CmdBatch :
+				{
+					WaitSemaphores( ev.batch.waitSemaphores );
+					ev.deps = EndDeps( first_dep );
+
+					const uint64_t*	sems = capture.GetHandles( ev.batch.signalSemaphores );
+					for (uint j = 0; j < ev.batch.signalSemaphores.count; ++j) {
+						signal_semaphores[ sems[j] ] = uid;
+					}
+					break;
+				}
+				case ESyncEvent::ResetFences :
+				{
+					const uint64_t*	fences = capture.GetHandles( ev.fences.fences );
+					for (uint j = 0; j < ev.fences.fences.count; ++j) {
+						signal_fences.erase( fences[j] );
+					}
+					break;
+				}
+				case ESyncEvent::WaitForFences :
+				{
+					const uint64_t*	fences = capture.GetHandles( ev.fences.fences );
+					for (uint j = 0; j < ev.fences.fences.count; ++j)
+					{
+						auto	iter = signal_fences.find( fences[j] );
+						if ( iter != signal_fences.end() )
+							deps.push_back( iter->second );
+					}
+					ev.deps = EndDeps( first_dep );
+					break;
+				}
+				case ESyncEvent::AcquireImage :
+				{
+					if ( ev.acquire.semaphore )
+						signal_semaphores[ ev.acquire.semaphore ] = uid;
+
+					if ( ev.acquire.fence )
+						signal_fences[ ev.acquire.fence ] = uid;
+
+					swapchains[ SwapchainImage{ ev.object, ev.acquire.imageIndex }] = uid;
+					break;
+				}
+				case ESyncEvent::QueuePresent :
+				{
+					WaitSemaphores( ev.present.waitSemaphores );
+					ev.deps = EndDeps( first_dep );
+
+					const uint		first_acquire	= uint(deps.size());
+					const uint64_t*	sw_images		= capture.GetHandles( ev.present.swapchains );
+
+					for (uint j = 0; j < ev.present.swapchains.count; ++j)
+					{
+						auto	iter = swapchains.find( SwapchainImage{ sw_images[j*2 + 0], sw_images[j*2 + 1] });
+						ASSERT( iter != swapchains.end() );
+
+						if ( iter != swapchains.end() )
+							deps.push_back( iter->second );
+					}
+					ev.present.acquireDeps = EndDeps( first_acquire );
+					break;
+				}
+				case ESyncEvent::DestroyObject :
+				{
+					// new object with the same handle must not depend on signals of the destroyed object
+					signal_semaphores.erase( ev.object );
+					signal_fences.erase( ev.object );
+
+					for (auto iter = swapchains.begin(); iter != swapchains.end();)
+					{
+						if ( iter->first.swapchain == ev.object )
+							iter = swapchains.erase( iter );
+						else
+							++iter;
+					}
+					break;
+				}
+				case ESyncEvent::QueueWaitIdle :
+				case ESyncEvent::DeviceWaitIdle :
+				case ESyncEvent::Unknown :
+				case ESyncEvent::_Count :
+					break;
+			}
+		}
+	}
+//-----------------------------------------------------------------------------
+
+	
+/*
+=================================================
+	ToChars
+=================================================
+*/
+	ND_ static StringView  ToChars (OUT char (&buf)[24], uint64_t value)
+	{
+		auto	res = std::to_chars( std::begin(buf), std::end(buf), value );
+		return StringView{ buf, size_t(res.ptr - buf) };
+	}
+	
+/*
+=================================================
+	QueueName
+=================================================
+*/
+	ND_ static StringView  QueueName (const SyncEventBuffer &capture, uint64_t q, OUT char (&buf)[24])
+	{
+		StringView	name = capture.FindQueueName( q );
+		return name.empty() ? ToChars( OUT buf, q ) : name;
+	}
+	
+/*
+=================================================
+	ThreadName
+=================================================
+*/
+	ND_ static StringView  ThreadName (const SyncEventBuffer &capture, ThreadID tid, OUT char (&buf)[24])
+	{
+		StringView	name = capture.FindThreadName( tid );
+		return name.empty() ? ToChars( OUT buf, uint(tid) ) : name;
+	}
+//-----------------------------------------------------------------------------
+
+
+/*
+=================================================
+	DotStream
+=================================================
+*/
+	DotStream&  DotStream::operator << (StringView str)
+	{
+		if ( _size + str.size() > CountOf(_buffer) )
+		{
+			_failed |= not Flush();
+
+			// too big for the buffer
+			if ( str.size() > CountOf(_buffer) )
+			{
+				_failed |= not _stream.Write( str );
+				return *this;
+			}
+		}
+
+		std::memcpy( _buffer + _size, str.data(), str.size() );
+		_size += str.size();
+		return *this;
+	}
+
+	DotStream&  DotStream::operator << (char c)
+	{
+		if ( _size == CountOf(_buffer) )
+			_failed |= not Flush();
+
+		_buffer[_size++] = c;
+		return *this;
+	}
+
+	DotStream&  DotStream::operator << (uint64_t value)
+	{
+		char	buf [24];
+		return *this << ToChars( OUT buf, value );
+	}
+
+	DotStream&  DotStream::operator << (HexColor col)
+	{
+		static constexpr char	digits[] = "0123456789abcdef";
+
+		const uint	val		= (uint(col.col.r) << 16) | (uint(col.col.g) << 8) | uint(col.col.b);
+		char		buf [6];
+
+		for (int i = 5, v = int(val); i >= 0; --i, v >>= 4) {
+			buf[i] = digits[ v & 0xF ];
+		}
+		return *this << StringView{ buf, CountOf(buf) };
+	}
+
+	bool  DotStream::Flush ()
+	{
+		if ( _size > 0 )
+		{
+			_failed |= not _stream.Write( _buffer, BytesU{_size} );
+			_size = 0;
+		}
+		return not _failed;
+	}
+//-----------------------------------------------------------------------------
+
+
+/*
+=================================================
+	V1
+=================================================
+*/
+	void  V1::_NodeStyle (DotStream &out, StringView name, const NodeStyle &style)
+	{
+		out << " [label=\"" << name << '"'
+			<< ", fontcolor=\"#" << HexColor{ style.labelColor } << '"';
+
+		if ( style.fontSize )
+			out << ", fontsize=" << uint64_t(style.fontSize);
+
+		out << ", fillcolor=\"#" << HexColor{ style.bgColor } << '"'
+			<< ", style=filled];\n";
+	}
+	
+	void  V1::_AcquirePresentNodeStyle (DotStream &out, StringView name)
+	{
+		NodeStyle	style;
+		style.bgColor		= HtmlColor::Lime;
+		style.labelColor	= HtmlColor::Black;
+		V1::_NodeStyle( out, name, style );
+	}
+
+	void  V1::_WaitOnHostNodeStyle (DotStream &out, StringView name)
+	{
+		NodeStyle	style;
+		style.bgColor		= HtmlColor::Red;
+		style.labelColor	= HtmlColor::White;
+		V1::_NodeStyle( out, name, style );
+	}
+
+	void  V1::_SubmitNodeStyle (DotStream &out, StringView name)
+	{
+		NodeStyle	style;
+		style.bgColor		= HtmlColor::Blue;
+		style.labelColor	= HtmlColor::White;
+		V1::_NodeStyle( out, name, style );
+	}
+
+	void  V1::_CmdBatchNodeStyle (DotStream &out, StringView name)
+	{
+		NodeStyle	style;
+		style.bgColor		= HtmlColor::DarkSlateGray;
+		style.labelColor	= HtmlColor::Gainsboro;
+		V1::_NodeStyle( out, name, style );
+	}
+
+	void  V1::_FenceNodeStyle (DotStream &out, StringView name)
+	{
+		NodeStyle	style;
+		style.bgColor		= HtmlColor::Gold;
+		style.labelColor	= HtmlColor::Black;
+		style.fontSize		= 8;
+
+		out << " [label=\"" << name << '"'
+			<< ", fontcolor=\"#" << HexColor{ style.labelColor } << '"'
+			<< ", fontsize=" << uint64_t(style.fontSize)
+			<< ", fillcolor=\"#" << HexColor{ style.bgColor } << '"'
+			<< ", style=filled"
+			<< ", margin=0, nojustify=true];\n";
+	}
+
+	void  V1::_SemaphoreEdge (DotStream &out, UID from, UID to)
+	{
+		out << '\t' << GpuNode{from} << ":e -> " << GpuNode{to} << ":w [color=\"#" << HexColor{ HtmlColor::Orange } << "\"];\n";
+	}
+	
+	void  V1::_SwapchainEdge (DotStream &out, UID from, UID to)
+	{
+		out << '\t' << GpuNode{from} << ":e -> " << GpuNode{to} << ":w [color=\"#" << HexColor{ HtmlColor::Lime } << "\"];\n";
+	}
+
+	void  V1::_CpuToGpuSyncEdge (DotStream &out, UID fromCpu, UID toGpu)
+	{
+		out << '\t' << CpuNode{fromCpu} << " -> " << GpuNode{toGpu} << " [color=\"#" << HexColor{ HtmlColor::DeepSkyBlue } << "\", minlen=2];\n";
+	}
+	
+	void  V1::_GpuToCpuSyncEdge (DotStream &out, UID fromGpu, UID toCpu)
+	{
+		out << '\t' << GpuNode{fromGpu} << " -> " << CpuNode{toCpu} << " [color=\"#" << HexColor{ HtmlColor::Red } << "\", minlen=2];\n";
+	}
+
+/*
+=================================================
+	_WriteSection
+----
+	events are traversed once per section, so sections are written
+	directly to the stream in the order of the dot-file.
+	timelines are filled in each pass.
+=================================================
+*/
+	void  V1::_WriteSection (DotStream &out, const SyncEventBuffer &capture, EDotSection section, OUT DotTimelines &timelines)
+	{
+		const bool	rank	= (section == EDotSection::Rank);
+		const bool	deps	= (section == EDotSection::Deps);
+
+		// fence is ranked by the submit exit time, so rank times are not ordered by events,
+		// rank chain is written after sorting to keep it monotonic and acyclic
+		Array<TimePoint>	rank_times;
+		if ( section == EDotSection::RankDecl )
+			rank_times.reserve( capture.events.size() );
+
+		auto	add_rank = [&out, &rank_times, section, last = TimePoint{~0ull}, first = true] (TimePoint time) mutable
+		{
+			if ( last == time )
+				return;
+
+			if ( section == EDotSection::RankDecl )
+				rank_times.push_back( time );
+
+			if ( section == EDotSection::Rank )
+			{
+				out << (first ? "" : "\t}\n")
+					<< "\t{\n"
+					<< "\t	rank = same; \"" << uint64_t(time) << "\";\n";
+			}
+			first	= false;
+			last	= time;
+		};
+
+		auto	cpu_timeline = [&out, &timelines, deps] (UID id, ThreadID tid)
+		{
+			auto	iter = timelines.threads.find( tid );
+			if ( deps )
+			{
+				out << '\t';
+				if ( iter != timelines.threads.end() )
+					out << CpuNode{ iter->second };
+				else
+					out << ThreadNode{ tid };
+				out << ":e -> " << CpuNode{id} << ":w [color=\"#" << HexColor{ HtmlColor::DeepSkyBlue } << "\", style=dotted, penwidth=2];\n";
+			}
+			timelines.threads.insert_or_assign( tid, id );
+		};
+
+		auto	gpu_timeline = [&out, &timelines, deps] (UID id, uint64_t queue)
+		{
+			auto	iter = timelines.queues.find( queue );
+			if ( deps )
+			{
+				out << '\t';
+				if ( iter != timelines.queues.end() )
+					out << GpuNode{ iter->second };
+				else
+					out << QueueNode{ queue };
+				out << ":e -> " << GpuNode{id} << ":w [color=\"#" << HexColor{ HtmlColor::DarkGreen } << "\", style=dotted, penwidth=2];\n";
+			}
+			timelines.queues.insert_or_assign( queue, id );
+		};
+			
+		for (size_t i = 0; i < capture.events.size(); ++i)
+		{
+			const auto&	ev		= capture.events[i];
+			const UID	uid		{ uint(i + 1) };
+			const auto	ev_deps	= [&capture] (const PoolRange &range) { return ArrayView<UID>{ capture.GetDeps( range ), range.count }; };
+
+			switch ( ev.type )
+			{
+				case ESyncEvent::QueueSubmit :
+				{
+					add_rank( ev.time );
+					if ( rank ) {
+						out << "\t\t" << CpuNode{uid};
+						V1::_SubmitNodeStyle( out, EnumEq( ev.flags, ESyncEventFlags::BindSparse ) ? "BindSparse" : "Submit" );
+					}
+					cpu_timeline( uid, ev.threadId );
+
+					// batches are stored after the submit
+					for (uint j = 1; j <= ev.submit.batchCount; ++j)
+					{
+						const auto&	batch		= capture.events[i + j];
+						const UID	batch_uid	{ uint(i + j + 1) };
+						ASSERT( batch.type == ESyncEvent::CmdBatch );
+
+						if ( rank ) {
+							out << "\t\t" << GpuNode{batch_uid};
+							V1::_CmdBatchNodeStyle( out, "CmdBatch" );
+						}
+						gpu_timeline( batch_uid, batch.object );
+
+						if ( deps )
+						{
+							V1::_CpuToGpuSyncEdge( out, uid, batch_uid );
+
+							for (auto& sem : ev_deps( batch.deps )) {
+								V1::_SemaphoreEdge( out, sem, batch_uid );
+							}
+						}
+					}
+
+					if ( ev.submit.fence )
+					{
+						add_rank( ev.EndTime() );
+						if ( rank ) {
+							out << "\t\t" << GpuNode{uid};
+							V1::_FenceNodeStyle( out, "Fence" );
+						}
+						if ( deps ) {
+							for (uint j = 1; j <= ev.submit.batchCount; ++j) {
+								V1::_SemaphoreEdge( out, UID{ uint(i + j + 1) }, uid );
+							}
+						}
+					}
+					break;
+				}
+
+				case ESyncEvent::CmdBatch :
+					break;	// processed with submit
+
+				case ESyncEvent::QueueWaitIdle :
+				{
+					add_rank( ev.time );
+					if ( rank ) {
+						out << "\t\t" << CpuNode{uid};
+						V1::_WaitOnHostNodeStyle( out, "Wait" );
+						out << "\t\t" << GpuNode{uid};
+						V1::_WaitOnHostNodeStyle( out, "Wait" );
+					}
+					cpu_timeline( uid, ev.threadId );
+					gpu_timeline( uid, ev.object );
+					if ( deps )
+						V1::_GpuToCpuSyncEdge( out, uid, uid );
+					break;
+				}
+
+				case ESyncEvent::DeviceWaitIdle :
+				{
+					add_rank( ev.time );
+					if ( rank ) {
+						out << "\t\t" << CpuNode{uid};
+						V1::_WaitOnHostNodeStyle( out, "Wait" );
+					}
+					cpu_timeline( uid, ev.threadId );
+					// TODO: insert node to all queues
+					break;
+				}
+
+				case ESyncEvent::ResetFences :
+					break;
+
+				case ESyncEvent::WaitForFences :
+				{
+					if ( EnumEq( ev.flags, ESyncEventFlags::Timeout ))
+						break;
+
+					add_rank( ev.time );
+					if ( rank ) {
+						out << "\t\t" << CpuNode{uid};
+						V1::_WaitOnHostNodeStyle( out, "Wait" );
+					}
+					cpu_timeline( uid, ev.threadId );
+
+					if ( deps ) {
+						for (auto& fence : ev_deps( ev.deps )) {
+							V1::_GpuToCpuSyncEdge( out, fence, uid );
+						}
+					}
+					break;
+				}
+
+				case ESyncEvent::AcquireImage :
+				{
+					add_rank( ev.time );
+					if ( rank ) {
+						out << "\t\t" << CpuNode{uid};
+						V1::_AcquirePresentNodeStyle( out, "Acquire" );
+						out << "\t\t" << GpuNode{uid};
+						V1::_AcquirePresentNodeStyle( out, "Acquire" );
+					}
+					cpu_timeline( uid, ev.threadId );
+					if ( deps )
+						V1::_CpuToGpuSyncEdge( out, uid, uid );
+					break;
+				}
+
+				case ESyncEvent::QueuePresent :
+				{
+					add_rank( ev.time );
+					if ( rank ) {
+						out << "\t\t" << CpuNode{uid};
+						V1::_AcquirePresentNodeStyle( out, "Present" );
+						out << "\t\t" << GpuNode{uid};
+						V1::_AcquirePresentNodeStyle( out, "Present" );
+					}
+					cpu_timeline( uid, ev.threadId );
+					gpu_timeline( uid, ev.object );
+
+					if ( deps )
+					{
+						V1::_CpuToGpuSyncEdge( out, uid, uid );
+
+						for (auto& acq : ev_deps( ev.present.acquireDeps )) {
+							V1::_SwapchainEdge( out, acq, uid );
+						}
+						for (auto& sem : ev_deps( ev.deps )) {
+							V1::_SemaphoreEdge( out, sem, uid );
+						}
+					}
+					break;
+				}
+
+				case ESyncEvent::DestroyObject :
+					break;	// used only to resolve dependencies
+
+				case ESyncEvent::Unknown :
+				case ESyncEvent::_Count :
+					ASSERT( false );
+					break;
+			}
+		}
+
+		if ( section == EDotSection::RankDecl )
+		{
+			std::sort( rank_times.begin(), rank_times.end() );
+			rank_times.erase( std::unique( rank_times.begin(), rank_times.end() ), rank_times.end() );
+
+			for (auto& time : rank_times) {
+				out << " -> \"" << uint64_t(time) << '"';
+			}
+		}
+	}
+
+/*
+=================================================
+	WriteDot_v1
+=================================================
+*/
+	bool  WriteDot_v1 (const SyncEventBuffer &capture, WStream &stream)
+	{
+		CHECK_ERR( stream.IsOpen() );
+
+		DotStream		out			{ stream };
+		DotTimelines	timelines;
+		char			name_buf	[24];
+
+		out << "digraph SyncAnalyzer {\n"
+			<< "	rankdir = LR;\n"
+			<< "	bgcolor = black;\n"
+			<< "	compound=true;\n\n"
+			<< "	{\n"
+			<< "		node [shape=plaintext, fontname=\"helvetica\", fontsize=5, fontcolor=white];\n"
+			<< "		\"init\"";
+
+		V1::_WriteSection( out, capture, EDotSection::RankDecl, OUT timelines );
+
+		out << ";\n"
+			<< "	}\n\n"
+			<< "	{\n"
+			<< "		rank = same; \"init\";\n"
+			<< "		node [shape=rectangle, fontname=\"helvetica\", penwidth=0.0];\n"
+			<< "		edge [fontname=\"helvetica\", fontcolor=white, minlen=1];\n";
+
+		for (auto& item : timelines.threads)
+		{
+			NodeStyle	style;
+			style.bgColor		= HtmlColor::Indigo;
+			style.labelColor	= HtmlColor::White;
+
+			out << "\t\t" << ThreadNode{ item.first };
+			V1::_NodeStyle( out, ThreadName( capture, item.first, OUT name_buf ), style );
+		}
+		for (auto& item : timelines.queues)
+		{
+			NodeStyle	style;
+			style.bgColor		= HtmlColor::DarkSlateGray;
+			style.labelColor	= HtmlColor::Gainsboro;
+
+			out << "\t\t" << QueueNode{ item.first };
+			V1::_NodeStyle( out, QueueName( capture, item.first, OUT name_buf ), style );
+		}
+
+		out << "	}\n\n"
+			<< "	node [shape=rectangle, fontname=\"helvetica\", penwidth=0.0];\n"
+			<< "	edge [fontname=\"helvetica\", fontcolor=white, minlen=1];\n";
+
+		timelines = {};
+		V1::_WriteSection( out, capture, EDotSection::Rank, OUT timelines );
+
+		out << "	}\n\n";
+
+		timelines = {};
+		V1::_WriteSection( out, capture, EDotSection::Deps, OUT timelines );
+
+		// keep thread and queue names in the same order
+		{
+			const ThreadID*	prev = null;
+			for (auto& item : timelines.threads)
+			{
+				if ( prev )
+					out << ThreadNode{ *prev } << " -> " << ThreadNode{ item.first } << " [minlen=0, style=invis];\n";
+				prev = &item.first;
+			}
+		}{
+			const uint64_t*	prev = null;
+			for (auto& item : timelines.queues)
+			{
+				if ( prev )
+					out << QueueNode{ *prev } << " -> " << QueueNode{ item.first } << " [minlen=0, style=invis];\n";
+				prev = &item.first;
+			}
+		}
+
+		out << "}\n";
+
+		return out.Flush();
+	}
+
+
+}	// SyncGraph
+}	// VSA
@@ -0,0 +1,31 @@
+// Copyright (c) 2019,  Zhirnov Andrey. For more information see 'LICENSE'
+
+#pragma once
+
+#include "src/SyncEvents.h"
+#include "stl/Stream/Stream.h"
+
+/*
+	Sync graph builder.
+
+	Doesn't depend on the Vulkan loader, so it is used by the layer
+	and by the offline tool that reads the binary trace.
+*/
+
+namespace VSA
+{
+namespace SyncGraph
+{
+
+	// sort events by time, order of events with the same time is kept
+	void  SortEvents (INOUT SyncEventBuffer &capture);
+
+	// events must be sorted, temporary maps are allocated in 'tempArena'
+	void  ResolveDependencies (INOUT SyncEventBuffer &capture, CaptureArena_t &tempArena);
+
+	// events must be sorted and resolved, graph is written to the stream without intermediate strings
+	ND_ bool  WriteDot_v1 (const SyncEventBuffer &capture, WStream &stream);
+
+
+}	// SyncGraph
+}	// VSA
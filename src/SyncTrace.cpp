@@ -0,0 +1,508 @@
+// Copyright (c) 2019,  Zhirnov Andrey. For more information see 'LICENSE'
+
+#include "src/SyncTrace.h"
+
+namespace VSA
+{
+namespace SyncTrace
+{
+namespace
+{
+	//
+	// Data Reader
+	//
+
+	struct Reader
+	{
+		const uint8_t *		ptr		= null;
+		const uint8_t *		end		= null;
+		bool				ok		= true;
+
+		explicit Reader (ArrayView<uint8_t> data) : ptr{data.data()}, end{data.data() + data.size()} {}
+
+		ND_ uint64_t  Var ()
+		{
+			uint64_t	result = 0;
+			for (uint shift = 0; shift < 64 and ptr < end; shift += 7)
+			{
+				const uint8_t	b = *(ptr++);
+				result |= uint64_t(b & 0x7F) << shift;
+
+				if ( not (b & 0x80) )
+					return result;
+			}
+			ok = false;
+			return 0;
+		}
+
+		ND_ int64_t  SVar ()
+		{
+			const uint64_t	v = Var();
+			return int64_t(v >> 1) ^ -int64_t(v & 1);
+		}
+
+		ND_ uint8_t  Byte ()
+		{
+			if ( ptr < end )
+				return *(ptr++);
+
+			ok = false;
+			return 0;
+		}
+
+		ND_ size_t  Remaining () const	{ return size_t(end - ptr); }
+
+		ND_ StringView  Str ()
+		{
+			const uint64_t	len = Var();
+			if ( uint64_t(end - ptr) < len )
+			{
+				ok = false;
+				return {};
+			}
+			StringView	str{ BitCast<const char *>(ptr), size_t(len) };
+			ptr += len;
+			return str;
+		}
+	};
+
+}	// namespace
+//-----------------------------------------------------------------------------
+
+
+
+/*
+=================================================
+	Encode
+=================================================
+*/
+	void  Encoder::Encode (const SyncEventBuffer &src, ArrayView<uint> frameIndex, INOUT ChunkHeader &header)
+	{
+		_dict.clear();
+		_dictValues.clear();
+		_data.clear();
+
+		// build dictionary
+		for (auto& ev : src.events)
+		{
+			_AddToDict( ev.object );
+
+			switch ( ev.type )
+			{
+				case ESyncEvent::QueueSubmit :
+					_AddToDict( ev.submit.fence );
+					break;
+
+				case ESyncEvent::CmdBatch :
+					_AddRangeToDict( src, ev.batch.waitSemaphores, 1 );
+					_AddRangeToDict( src, ev.batch.signalSemaphores, 1 );
+					break;
+
+				case ESyncEvent::ResetFences :
+				case ESyncEvent::WaitForFences :
+					_AddRangeToDict( src, ev.fences.fences, 1 );
+					break;
+
+				case ESyncEvent::AcquireImage :
+					_AddToDict( ev.acquire.semaphore );
+					_AddToDict( ev.acquire.fence );
+					break;
+
+				case ESyncEvent::QueuePresent :
+					_AddRangeToDict( src, ev.present.waitSemaphores, 1 );
+					_AddRangeToDict( src, ev.present.swapchains, 2 );
+					break;
+
+				default :
+					break;
+			}
+		}
+		for (auto& item : src.queueNames) {
+			_AddToDict( item.object );
+		}
+
+		// frame index
+		for (size_t i = 0, prev = 0; i < frameIndex.size(); ++i)
+		{
+			_WriteVar( frameIndex[i] - prev );
+			prev = frameIndex[i];
+		}
+
+		// dictionary
+		_WriteVar( _dictValues.size() );
+		for (size_t i = 0; i < _dictValues.size(); ++i) {
+			_WriteSVar( int64_t(_dictValues[i] - (i ? _dictValues[i-1] : 0)) );
+		}
+
+		// events
+		TimePoint	last_time {0};
+		for (auto& ev : src.events) {
+			_EncodeEvent( src, ev, INOUT last_time );
+		}
+
+		// names
+		for (auto& item : src.queueNames)
+		{
+			_WriteHandle( item.object );
+			_WriteString( src.GetString( item.name ));
+		}
+		for (auto& item : src.threadNames)
+		{
+			_WriteVar( item.object );
+			_WriteString( src.GetString( item.name ));
+		}
+
+		header.encodedSize		= uint(_data.size());
+		header.frameCount		= uint(frameIndex.size());
+		header.eventCount		= uint(src.events.size());
+		header.handleCount		= uint(src.handles.size());
+		header.stringSize		= uint(src.strings.size());
+		header.queueNameCount	= uint(src.queueNames.size());
+		header.threadNameCount	= uint(src.threadNames.size());
+	}
+
+/*
+=================================================
+	_EncodeEvent
+=================================================
+*/
+	void  Encoder::_EncodeEvent (const SyncEventBuffer &src, const SyncEvent &ev, INOUT TimePoint &lastTime)
+	{
+		STATIC_ASSERT( uint(ESyncEvent::_Count) <= 0x10 );
+		ASSERT( uint(ev.flags) <= 0xF );
+
+		_data.push_back( uint8_t(uint(ev.type) | (uint(ev.flags) << 4)) );
+		_WriteVar( uint(ev.threadId) );
+		_WriteSVar( int64_t(uint64_t(ev.time) - uint64_t(lastTime)) );
+		_WriteVar( ev.duration );
+		_WriteHandle( ev.object );
+
+		lastTime = ev.time;
+
+		switch ( ev.type )
+		{
+			case ESyncEvent::QueueSubmit :
+				_WriteHandle( ev.submit.fence );
+				_WriteVar( ev.submit.batchCount );
+				break;
+
+			case ESyncEvent::CmdBatch :
+				_WriteHandles( src, ev.batch.waitSemaphores );
+				_WriteHandles( src, ev.batch.signalSemaphores );
+				break;
+
+			case ESyncEvent::ResetFences :
+			case ESyncEvent::WaitForFences :
+				_WriteHandles( src, ev.fences.fences );
+				break;
+
+			case ESyncEvent::AcquireImage :
+				_WriteHandle( ev.acquire.semaphore );
+				_WriteHandle( ev.acquire.fence );
+				_WriteVar( ev.acquire.imageIndex );
+				break;
+
+			case ESyncEvent::QueuePresent :
+			{
+				_WriteHandles( src, ev.present.waitSemaphores );
+				_WriteVar( ev.present.swapchains.count );
+
+				auto*	swapchains = src.GetHandles( ev.present.swapchains );
+				for (uint i = 0; i < ev.present.swapchains.count; ++i)
+				{
+					_WriteHandle( swapchains[i*2+0] );
+					_WriteVar( swapchains[i*2+1] );		// image index
+				}
+				break;
+			}
+
+			default :
+				break;
+		}
+	}
+
+/*
+=================================================
+	_AddToDict
+=================================================
+*/
+	inline void  Encoder::_AddToDict (uint64_t value)
+	{
+		if ( _dict.insert({ value, uint(_dictValues.size()) }).second )
+			_dictValues.push_back( value );
+	}
+
+	void  Encoder::_AddRangeToDict (const SyncEventBuffer &src, const PoolRange &range, uint stride)
+	{
+		auto*	handles = src.GetHandles( range );
+
+		for (uint i = 0; i < range.count; ++i) {
+			_AddToDict( handles[i * stride] );
+		}
+	}
+
+/*
+=================================================
+	_WriteVar
+=================================================
+*/
+	inline void  Encoder::_WriteVar (uint64_t value)
+	{
+		for (; value >= 0x80; value >>= 7) {
+			_data.push_back( uint8_t(value | 0x80) );
+		}
+		_data.push_back( uint8_t(value) );
+	}
+
+	inline void  Encoder::_WriteSVar (int64_t value)
+	{
+		_WriteVar( (uint64_t(value) << 1) ^ uint64_t(value >> 63) );
+	}
+
+/*
+=================================================
+	_WriteHandle
+=================================================
+*/
+	inline void  Encoder::_WriteHandle (uint64_t value)
+	{
+		auto	iter = _dict.find( value );
+		ASSERT( iter != _dict.end() );
+
+		_WriteVar( iter->second );
+	}
+
+	void  Encoder::_WriteHandles (const SyncEventBuffer &src, const PoolRange &range)
+	{
+		auto*	handles = src.GetHandles( range );
+
+		_WriteVar( range.count );
+
+		for (uint i = 0; i < range.count; ++i) {
+			_WriteHandle( handles[i] );
+		}
+	}
+
+/*
+=================================================
+	_WriteString
+=================================================
+*/
+	void  Encoder::_WriteString (StringView str)
+	{
+		_WriteVar( str.size() );
+		_data.insert( _data.end(), str.begin(), str.end() );
+	}
+//-----------------------------------------------------------------------------
+
+
+
+/*
+=================================================
+	Decode
+=================================================
+*/
+	bool  Decode (ArrayView<uint8_t> data, const ChunkHeader &header, INOUT Array<Frame> &frames, INOUT SyncEventBuffer &dst)
+	{
+		CHECK_ERR( header.magic == ChunkMagic );
+		CHECK_ERR( data.size() == header.encodedSize );
+
+		// each frame, event and handle is encoded with at least one byte,
+		// so corrupted counts are rejected before memory is reserved
+		CHECK_ERR( header.frameCount <= data.size() and header.eventCount <= data.size() and header.handleCount <= data.size() );
+
+		Reader			rd		{ data };
+		const uint		base	= uint(dst.events.size());
+		Array<uint64_t>	dict;
+
+		const auto	ReadHandle = [&rd, &dict] () -> uint64_t
+		{
+			const uint64_t	idx = rd.Var();
+			if ( idx < dict.size() )
+				return dict[ size_t(idx) ];
+
+			rd.ok = false;
+			return 0;
+		};
+
+		const auto	ReadHandles = [&rd, &dst, &ReadHandle] () -> PoolRange
+		{
+			PoolRange		range{ uint(dst.handles.size()), 0 };
+			const uint64_t	count = rd.Var();
+
+			if ( count > rd.Remaining() )
+			{
+				rd.ok = false;
+				return range;
+			}
+
+			range.count = uint(count);
+			for (uint i = 0; i < range.count and rd.ok; ++i) {
+				dst.handles.push_back( ReadHandle() );
+			}
+			return range;
+		};
+
+		// frame index
+		const size_t	first_frame = frames.size();
+		for (uint i = 0, prev = 0; i < header.frameCount and rd.ok; ++i)
+		{
+			prev += uint(rd.Var());
+			frames.push_back({ header.firstFrame + i, base + prev });
+		}
+
+		// dictionary
+		const uint64_t	dict_size = rd.Var();
+		CHECK_ERR( rd.ok and dict_size <= data.size() );
+		dict.resize( size_t(dict_size) );
+
+		for (size_t i = 0; i < dict.size(); ++i) {
+			dict[i] = uint64_t(rd.SVar()) + (i ? dict[i-1] : 0);
+		}
+
+		// events
+		dst.events.reserve( dst.events.size() + header.eventCount );
+		dst.handles.reserve( dst.handles.size() + header.handleCount );
+
+		uint64_t	time = 0;
+		for (uint i = 0; i < header.eventCount and rd.ok; ++i)
+		{
+			const uint8_t	type_flags = rd.Byte();
+
+			auto&	ev = dst.events.emplace_back();
+			ev.type		= ESyncEvent(type_flags & 0xF);
+			ev.flags	= ESyncEventFlags(type_flags >> 4);
+			ev.threadId	= ThreadID(rd.Var());
+			time		+= uint64_t(rd.SVar());
+			ev.time		= TimePoint(time);
+			ev.duration	= uint(rd.Var());
+			ev.object	= ReadHandle();
+
+			switch ( ev.type )
+			{
+				case ESyncEvent::QueueSubmit :
+					ev.submit.fence			= ReadHandle();
+					ev.submit.batchCount	= uint(rd.Var());
+
+					// batches are stored after the submit
+					if ( ev.submit.batchCount >= header.eventCount - i )
+						rd.ok = false;
+					break;
+
+				case ESyncEvent::CmdBatch :
+					ev.batch.waitSemaphores		= ReadHandles();
+					ev.batch.signalSemaphores	= ReadHandles();
+					break;
+
+				case ESyncEvent::ResetFences :
+				case ESyncEvent::WaitForFences :
+					ev.fences.fences = ReadHandles();
+					break;
+
+				case ESyncEvent::AcquireImage :
+					ev.acquire.semaphore	= ReadHandle();
+					ev.acquire.fence		= ReadHandle();
+					ev.acquire.imageIndex	= uint(rd.Var());
+					break;
+
+				case ESyncEvent::QueuePresent :
+				{
+					ev.present.waitSemaphores	= ReadHandles();
+					ev.present.swapchains		= PoolRange{ uint(dst.handles.size()), uint(rd.Var()) };
+
+					// swapchain and image index
+					if ( ev.present.swapchains.count > rd.Remaining() / 2 )
+					{
+						rd.ok = false;
+						break;
+					}
+
+					for (uint j = 0; j < ev.present.swapchains.count and rd.ok; ++j)
+					{
+						dst.handles.push_back( ReadHandle() );
+						dst.handles.push_back( rd.Var() );
+					}
+					break;
+				}
+
+				default :
+					CHECK_ERR( ev.type < ESyncEvent::_Count );
+					break;
+			}
+		}
+
+		// names
+		for (uint i = 0; i < header.queueNameCount and rd.ok; ++i)
+		{
+			const uint64_t	queue	= ReadHandle();
+			StringView		name	= rd.Str();
+
+			if ( dst.FindQueueName( queue ).empty() )
+				dst.SetQueueName( queue, name );
+		}
+		for (uint i = 0; i < header.threadNameCount and rd.ok; ++i)
+		{
+			const ThreadID	tid		{ uint(rd.Var()) };
+			StringView		name	= rd.Str();
+
+			if ( dst.FindThreadName( tid ).empty() )
+				dst.SetThreadName( tid, name );
+		}
+
+		CHECK_ERR( rd.ok and rd.ptr == rd.end );
+
+		// frames must point to the decoded events
+		for (size_t i = first_frame; i < frames.size(); ++i) {
+			CHECK_ERR( frames[i].firstEvent <= dst.events.size() );
+		}
+
+		// batches are stored after the submit, graph relies on it
+		for (size_t i = base; i < dst.events.size(); ++i)
+		{
+			const auto&	ev = dst.events[i];
+			CHECK_ERR( ev.type != ESyncEvent::CmdBatch );
+
+			if ( ev.type == ESyncEvent::QueueSubmit )
+			{
+				for (uint j = 0; j < ev.submit.batchCount; ++j) {
+					CHECK_ERR( dst.events[++i].type == ESyncEvent::CmdBatch );
+				}
+			}
+		}
+		return true;
+	}
+
+/*
+=================================================
+	ReadAll
+----
+	events of all chunks are appended to 'dst',
+	'frames' contains number and first event of each frame,
+	frames dropped by the writer are missing.
+=================================================
+*/
+	bool  ReadAll (RStream &stream, INOUT Array<Frame> &frames, INOUT SyncEventBuffer &dst)
+	{
+		CHECK_ERR( stream.IsOpen() );
+
+		FileHeader	file_header;
+		CHECK_ERR( stream.Read( &file_header, SizeOf<FileHeader> ));
+		CHECK_ERR( file_header.magic == FileMagic );
+		CHECK_ERR( file_header.version >= MinVersion and file_header.version <= Version );
+
+		Array<uint8_t>	data;
+
+		for (; stream.Position() < stream.Size();)
+		{
+			ChunkHeader	header;
+			CHECK_ERR( stream.Read( &header, SizeOf<ChunkHeader> ));
+			CHECK_ERR( header.magic == ChunkMagic );
+			CHECK_ERR( stream.Read( header.encodedSize, OUT data ));
+			CHECK_ERR( Decode( data, header, INOUT frames, INOUT dst ));
+		}
+		return true;
+	}
+
+
+}	// SyncTrace
+}	// VSA
@@ -0,0 +1,142 @@
+// Copyright (c) 2019,  Zhirnov Andrey. For more information see 'LICENSE'
+
+#pragma once
+
+#include "src/SyncEvents.h"
+#include "stl/Containers/ArrayView.h"
+#include "stl/Stream/Stream.h"
+
+/*
+	Binary trace format.
+
+	File:
+		FileHeader
+		Chunk[]				- until end of file
+
+	Chunk:
+		ChunkHeader
+		uint8_t				data [encodedSize]
+
+	Chunk data, 'varint' is LEB128, 'svarint' is zigzag + LEB128:
+		varint				frameIndex [frameCount]			- delta of the first event index of each frame
+		varint				dictSize
+		svarint				dict [dictSize]					- delta of handle values, handles are referenced by index
+		Event				events [eventCount]
+		QueueName			queueNames [queueNameCount]
+		ThreadName			threadNames [threadNameCount]
+
+	Event:
+		uint8_t				type | (flags << 4)
+		varint				threadId
+		svarint				time delta from previous event
+		varint				duration
+		varint				object							- dictionary index
+		...					payload, depends on type, see 'Encoder::_EncodeEvent()'
+
+	QueueName:	varint queue (dictionary index), varint length, char name [length]
+	ThreadName:	varint threadId, varint length, char name [length]
+
+	Events are sorted by time inside each frame.
+	Resolved dependencies are not stored.
+*/
+
+namespace VSA
+{
+namespace SyncTrace
+{
+
+	static constexpr uint	FileMagic		= 'V' | ('S' << 8) | ('A' << 16) | ('T' << 24);
+	static constexpr uint	ChunkMagic		= 'C' | ('H' << 8) | ('N' << 16) | ('K' << 24);
+	static constexpr uint	Version			= 3;
+	static constexpr uint	MinVersion		= 2;	// previous versions have subset of events
+
+
+	//
+	// File Header
+	//
+
+	struct FileHeader
+	{
+		uint		magic			= FileMagic;
+		uint		version			= Version;
+	};
+
+
+	//
+	// Chunk Header
+	//
+
+	struct ChunkHeader
+	{
+		uint		magic			= ChunkMagic;
+		uint		encodedSize		= 0;	// size of data after the header
+		uint		firstFrame		= 0;	// frames in the chunk are consecutive, dropped frames are between chunks
+		uint		frameCount		= 0;
+		uint		eventCount		= 0;
+		uint		handleCount		= 0;	// decoded size, can be used to reserve memory
+		uint		stringSize		= 0;	// decoded size
+		uint		queueNameCount	= 0;
+		uint		threadNameCount	= 0;
+	};
+
+	STATIC_ASSERT( std::is_trivially_copyable_v< FileHeader >);
+	STATIC_ASSERT( std::is_trivially_copyable_v< ChunkHeader >);
+
+
+	//
+	// Decoded Frame
+	//
+
+	struct Frame
+	{
+		uint		id				= 0;	// frame number since the trace was opened, see 'ChunkHeader::firstFrame'
+		uint		firstEvent		= 0;	// index in decoded events
+	};
+
+
+
+	//
+	// Chunk Encoder
+	//
+
+	class Encoder
+	{
+	// variables
+	private:
+		HashMap< uint64_t, uint >	_dict;
+		Array< uint64_t >			_dictValues;
+		Array< uint8_t >			_data;
+
+
+	// methods
+	public:
+		// all buffers are reused, so memory is allocated only for the first chunks
+		void  Encode (const SyncEventBuffer &src, ArrayView<uint> frameIndex, INOUT ChunkHeader &header);
+
+		ND_ ArrayView<uint8_t>  Data () const	{ return _data; }
+
+	private:
+		void  _AddToDict (uint64_t value);
+		void  _AddRangeToDict (const SyncEventBuffer &src, const PoolRange &range, uint stride);
+		void  _WriteVar (uint64_t value);
+		void  _WriteSVar (int64_t value);
+		void  _WriteHandle (uint64_t value);
+		void  _WriteHandles (const SyncEventBuffer &src, const PoolRange &range);
+		void  _WriteString (StringView str);
+		void  _EncodeEvent (const SyncEventBuffer &src, const SyncEvent &ev, INOUT TimePoint &lastTime);
+	};
+
+
+	//
+	// Chunk Decoder
+	//
+
+	// events are appended to 'dst', 'Frame::firstEvent' is relative to 'dst'
+	ND_ bool  Decode (ArrayView<uint8_t> data, const ChunkHeader &header, INOUT Array<Frame> &frames, INOUT SyncEventBuffer &dst);
+
+	// reads and decodes all chunks from the stream, stream must be at the beginning of the file
+	ND_ bool  ReadAll (RStream &stream, INOUT Array<Frame> &frames, INOUT SyncEventBuffer &dst);
+
+
+}	// SyncTrace
+}	// VSA
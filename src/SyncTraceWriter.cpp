@@ -0,0 +1,284 @@
+// Copyright (c) 2019,  Zhirnov Andrey. For more information see 'LICENSE'
+
+#include "src/SyncTraceWriter.h"
+#include "stl/Algorithms/StringUtils.h"
+#include <algorithm>
+
+namespace VSA
+{
+namespace
+{
+/*
+=================================================
+	FrameSize
+----
+	size of the frame data when it is appended to the chunk
+=================================================
+*/
+	ND_ BytesU  FrameSize (const SyncEventBuffer &frame)
+	{
+		return	SizeOf<SyncEvent> * frame.events.size() +
+				SizeOf<uint64_t> * frame.handles.size() +
+				SizeOf<UID> * frame.deps.size() +
+				SizeOf<char> * frame.strings.size() +
+				SizeOf<SyncEventBuffer::ObjectName> * (frame.queueNames.size() + frame.threadNames.size());
+	}
+
+}	// namespace
+//-----------------------------------------------------------------------------
+
+
+/*
+=================================================
+	constructor
+=================================================
+*/
+	SyncTraceWriter::SyncTraceWriter ()
+	{
+		_chunks.resize( _chunkCount );
+
+		for (auto& chunk : _chunks)
+		{
+			chunk.reset( new Chunk{} );
+			chunk->arena.SetBlockSize( _arenaBlockSize );
+			chunk->frameIndex.reserve( _maxChunkFrames );
+		}
+	}
+
+/*
+=================================================
+	destructor
+=================================================
+*/
+	SyncTraceWriter::~SyncTraceWriter ()
+	{
+		Close();
+	}
+
+/*
+=================================================
+	Open
+=================================================
+*/
+	bool  SyncTraceWriter::Open (StringView filename)
+	{
+		Close();
+
+		_file.reset( new FileWStream{ filename });
+
+		if ( not _file->IsOpen() )
+		{
+			_file.reset();
+			RETURN_ERR( "can't open trace file" );
+		}
+
+		_frameCounter	= 0;
+		_bytesWritten	= 0;
+		_rawSize		= 0;
+		_chunksWritten	= 0;
+		_framesDropped	= 0;
+		_maxQueued		= 0;
+		_writeFailed	= false;
+
+		const SyncTrace::FileHeader	header;
+		if ( not _Write( &header, 1 ))
+		{
+			// writer thread is not started yet, 'Close()' must not join it
+			_file.reset();
+			RETURN_ERR( "failed to write trace header" );
+		}
+
+		for (auto& chunk : _chunks) {
+			CHECK( _free.Push( chunk.get() ));
+		}
+
+		_looping.store( true, std::memory_order_relaxed );
+		_thread = std::thread{ [this] () { _WriterLoop(); }};
+		return true;
+	}
+
+/*
+=================================================
+	AddFrame
+----
+	events are copied, so 'frame' can be reused after call.
+	must not be called concurrently.
+	chunk is submitted before the frame that doesn't fit into '_maxChunkSize'.
+=================================================
+*/
+	void  SyncTraceWriter::AddFrame (const SyncEventBuffer &frame)
+	{
+		if ( not IsOpen() )
+			return;
+
+		const uint	frame_id = _frameCounter++;
+
+		if ( _current and _current->frameIndex.size() and _current->arena.UsedSize() + FrameSize( frame ) > _maxChunkSize )
+			_SubmitChunk();
+
+		if ( not _current )
+		{
+			// writer thread is too slow, frame is lost
+			if ( not _free.Pop( OUT _current ))
+			{
+				_framesDropped.fetch_add( 1, std::memory_order_relaxed );
+				return;
+			}
+			_current->firstFrame = frame_id;
+		}
+
+		auto&			chunk	= _current->events;
+		const size_t	first	= chunk.events.size();
+
+		_current->frameIndex.push_back( uint(first) );
+		chunk.Append( frame );
+
+		// stable sort keeps the submit and its batches together
+		std::stable_sort( chunk.events.begin() + first, chunk.events.end(),
+						  [] (auto& lhs, auto& rhs) { return lhs.time < rhs.time; });
+
+		for (auto& item : frame.queueNames)
+		{
+			if ( chunk.FindQueueName( item.object ).empty() )
+				chunk.SetQueueName( item.object, frame.GetString( item.name ));
+		}
+		for (auto& item : frame.threadNames)
+		{
+			const ThreadID	tid { uint(item.object) };
+
+			if ( chunk.FindThreadName( tid ).empty() )
+				chunk.SetThreadName( tid, frame.GetString( item.name ));
+		}
+
+		if ( _current->frameIndex.size() >= _maxChunkFrames or _current->arena.UsedSize() >= _maxChunkSize )
+			_SubmitChunk();
+	}
+
+/*
+=================================================
+	_SubmitChunk
+=================================================
+*/
+	void  SyncTraceWriter::_SubmitChunk ()
+	{
+		if ( not _current )
+			return;
+
+		// can't fail, queue size is equal to the chunk count
+		CHECK( _filled.Push( _current ));
+		_current = null;
+
+		const uint	queued	= uint(_filled.Count());
+		uint		prev	= _maxQueued.load( std::memory_order_relaxed );
+		while ( prev < queued and not _maxQueued.compare_exchange_weak( INOUT prev, queued, std::memory_order_relaxed )) {}
+
+		_wakeCV.notify_one();
+	}
+
+/*
+=================================================
+	Close
+----
+	waits until all chunks are written
+=================================================
+*/
+	bool  SyncTraceWriter::Close ()
+	{
+		if ( not IsOpen() )
+			return false;
+
+		_SubmitChunk();
+
+		_looping.store( false, std::memory_order_release );
+		_wakeCV.notify_one();
+
+		if ( _thread.joinable() )
+			_thread.join();
+
+		_file->Flush();
+		_file.reset();
+
+		// return chunks to initial state
+		for (Chunk* chunk; _free.Pop( OUT chunk );) {}
+
+		return not _writeFailed.load( std::memory_order_relaxed );
+	}
+
+/*
+=================================================
+	_WriterLoop
+=================================================
+*/
+	void  SyncTraceWriter::_WriterLoop ()
+	{
+		const auto	WriteAll = [this] ()
+		{
+			for (Chunk* chunk; _filled.Pop( OUT chunk );)
+			{
+				if ( not _WriteChunk( *chunk ))
+					_writeFailed.store( true, std::memory_order_relaxed );
+
+				chunk->events.Clear();
+				chunk->frameIndex.clear();
+				chunk->arena.Discard();
+
+				CHECK( _free.Push( chunk ));
+			}
+		};
+
+		while ( _looping.load( std::memory_order_acquire ))
+		{
+			WriteAll();
+
+			// timeout is used because notification may be missed
+			std::unique_lock<std::mutex>	lock{ _wakeGuard };
+			_wakeCV.wait_for( lock, std::chrono::milliseconds(10) );
+		}
+
+		// last chunk was pushed before '_looping' was reset
+		WriteAll();
+	}
+
+/*
+=================================================
+	_Write
+=================================================
+*/
+	template <typename T>
+	bool  SyncTraceWriter::_Write (const T* data, size_t count)
+	{
+		if ( count == 0 )
+			return true;
+
+		const BytesU	size = SizeOf<T> * count;
+
+		_bytesWritten.fetch_add( uint64_t(size), std::memory_order_relaxed );
+		return _file->Write( data, size );
+	}
+
+/*
+=================================================
+	_WriteChunk
+----
+	chunk is encoded on the writer thread
+=================================================
+*/
+	bool  SyncTraceWriter::_WriteChunk (const Chunk &chunk)
+	{
+		SyncTrace::ChunkHeader	header;
+		header.firstFrame = chunk.firstFrame;
+
+		_encoder.Encode( chunk.events, chunk.frameIndex, INOUT header );
+
+		auto	data = _encoder.Data();
+
+		CHECK_ERR( _Write( &header, 1 ) and _Write( data.data(), data.size() ));
+
+		_rawSize.fetch_add( uint64_t(SizeOf<SyncEvent> * chunk.events.events.size() + SizeOf<uint64_t> * chunk.events.handles.size()),
+							std::memory_order_relaxed );
+		_chunksWritten.fetch_add( 1, std::memory_order_relaxed );
+		return true;
+	}
+
+
+}	// VSA
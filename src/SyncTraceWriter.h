@@ -0,0 +1,99 @@
+// Copyright (c) 2019,  Zhirnov Andrey. For more information see 'LICENSE'
+
+#pragma once
+
+#include "src/SyncTrace.h"
+#include "stl/Stream/FileStream.h"
+#include "stl/Containers/SpscQueue.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace VSA
+{
+
+	//
+	// Sync Trace Writer
+	//
+	// Frames are collected into chunks on the calling thread,
+	// completed chunks are written to the file by the background thread.
+	// If all chunks are waiting for the writer then new frames are dropped.
+	//
+
+	class SyncTraceWriter
+	{
+	// types
+	private:
+		struct Chunk
+		{
+			CaptureArena_t			arena;
+			SyncEventBuffer			events		{arena};
+			Array<uint>				frameIndex;			// first event of each frame in 'events'
+			uint					firstFrame	= 0;
+		};
+
+		static constexpr uint	_chunkCount		= 8;
+		static constexpr uint	_maxChunkFrames	= 32;
+		static constexpr BytesU	_maxChunkSize	= 4_Mb;		// frame is not split, so chunk with a single big frame may be larger
+		static constexpr BytesU	_arenaBlockSize	= 1_Mb;		// chunks with small frames don't allocate '_maxChunkSize'
+
+		using ChunkQueue_t	= SpscQueue< Chunk*, _chunkCount >;
+
+
+	// variables
+	private:
+		UniquePtr<FileWStream>		_file;				// used by the writer thread while it is running
+		SyncTrace::Encoder			_encoder;			// used by the writer thread
+		Array<UniquePtr<Chunk>>		_chunks;
+		Chunk *						_current		= null;		// chunk for the next frame
+		uint						_frameCounter	= 0;
+
+		ChunkQueue_t				_filled;			// to the writer thread
+		ChunkQueue_t				_free;				// from the writer thread
+
+		std::thread					_thread;
+		std::atomic<bool>			_looping		{false};
+		std::mutex					_wakeGuard;
+		std::condition_variable		_wakeCV;
+
+		// statistics
+		std::atomic<uint64_t>		_bytesWritten	{0};
+		std::atomic<uint64_t>		_rawSize		{0};	// size of events and handles before encoding
+		std::atomic<uint>			_chunksWritten	{0};
+		std::atomic<uint>			_framesDropped	{0};
+		std::atomic<uint>			_maxQueued		{0};	// high-water mark of '_filled'
+		std::atomic<bool>			_writeFailed	{false};
+
+
+	// methods
+	public:
+		SyncTraceWriter ();
+		~SyncTraceWriter ();
+
+		SyncTraceWriter (const SyncTraceWriter &) = delete;
+		SyncTraceWriter&  operator = (const SyncTraceWriter &) = delete;
+
+		bool  Open (StringView filename);
+		void  AddFrame (const SyncEventBuffer &frame);
+		bool  Close ();
+
+		ND_ bool		IsOpen ()			const	{ return _file != null; }
+		ND_ uint		FrameCount ()		const	{ return _frameCounter; }
+		ND_ BytesU		BytesWritten ()		const	{ return BytesU{ _bytesWritten.load( std::memory_order_relaxed )}; }
+		ND_ BytesU		RawSize ()			const	{ return BytesU{ _rawSize.load( std::memory_order_relaxed )}; }
+		ND_ uint		ChunksWritten ()	const	{ return _chunksWritten.load( std::memory_order_relaxed ); }
+		ND_ uint		FramesDropped ()	const	{ return _framesDropped.load( std::memory_order_relaxed ); }
+		ND_ uint		MaxQueuedChunks ()	const	{ return _maxQueued.load( std::memory_order_relaxed ); }
+
+	private:
+		void  _SubmitChunk ();
+		void  _WriterLoop ();
+		bool  _WriteChunk (const Chunk &chunk);
+
+		template <typename T>
+		bool  _Write (const T* data, size_t count);
+	};
+
+
+}	// VSA
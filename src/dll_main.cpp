@@ -3,6 +3,7 @@
 #include "src/LayerManager.h"
 #include "vulkan/vk_layer.h"
 
+#ifdef PLATFORM_WINDOWS
 BOOL WINAPI DllMain(HINSTANCE hinstDLL, DWORD fdwReason, LPVOID lpvReserved)
 {
 	switch (fdwReason)
@@ -16,10 +17,14 @@ BOOL WINAPI DllMain(HINSTANCE hinstDLL, DWORD fdwReason, LPVOID lpvReserved)
 
 	return TRUE;
 }
+#endif
 
 extern "C"
 {
-	#define VK_LAYER_EXPORT
+	// functions are exported by 'export.def' on Windows, 'vk_layer.h' defines visibility attribute for GCC and Clang
+	#ifndef VK_LAYER_EXPORT
+	#	define VK_LAYER_EXPORT
+	#endif
 
 	VK_LAYER_EXPORT VKAPI_ATTR VkResult VKAPI_CALL
 										vkNegotiateLoaderLayerInterfaceVersion(VkNegotiateLayerInterface* pVersionStruct)
@@ -3,6 +3,7 @@
 #pragma once
 
 #include <functional>
+#include <string_view>
 #include "stl/Log/Log.h"
 #include "stl/CompileTime/TypeTraits.h"
 
@@ -101,7 +102,11 @@ namespace VSA
 	ND_ forceinline HashVal  HashOf (const void *ptr, size_t sizeInBytes)
 	{
 		ASSERT( ptr and sizeInBytes );
+#	ifdef COMPILER_MSVC
 		return HashVal{std::_Hash_array_representation( static_cast<const unsigned char*>(ptr), sizeInBytes )};
+#	else
+		return HashVal{std::hash<std::string_view>{}( std::string_view{ static_cast<const char*>(ptr), sizeInBytes })};
+#	endif
 	}
 
 }	// VSA
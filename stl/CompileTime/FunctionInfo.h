@@ -67,7 +67,7 @@ namespace VSA
 			static constexpr bool	is_volatile	= false;
 		};
 
-		#define _DECL_FUNC_INFO( _cv_qual_ ) \
+		#define _DECL_FUNC_INFO( _cv_qual_, _is_const_, _is_volatile_ ) \
 			template <typename Class, typename Result, typename ...Args> \
 			struct _FuncInfo< Result (Class::*) (Args...) _cv_qual_ > \
 			{ \
@@ -76,32 +76,32 @@ namespace VSA
 				using type		= Result (Class::*) (Args...) _cv_qual_; \
 				using clazz		= Class; \
 				\
-				static constexpr bool	is_const	= std::is_const_v< _cv_qual_ int >; \
-				static constexpr bool	is_volatile	= std::is_volatile_v< _cv_qual_ int >; \
+				static constexpr bool	is_const	= _is_const_; \
+				static constexpr bool	is_volatile	= _is_volatile_; \
 			};
-		_DECL_FUNC_INFO( const );
-		_DECL_FUNC_INFO( volatile );
-		_DECL_FUNC_INFO( const volatile );
-		_DECL_FUNC_INFO( noexcept );
-		_DECL_FUNC_INFO( const noexcept );
-		_DECL_FUNC_INFO( volatile noexcept );
-		_DECL_FUNC_INFO( const volatile noexcept );
-		_DECL_FUNC_INFO( & );
-		_DECL_FUNC_INFO( const & );
-		_DECL_FUNC_INFO( volatile & );
-		_DECL_FUNC_INFO( const volatile & );
-		_DECL_FUNC_INFO( & noexcept );
-		_DECL_FUNC_INFO( const & noexcept );
-		_DECL_FUNC_INFO( volatile & noexcept );
-		_DECL_FUNC_INFO( const volatile & noexcept );
-		_DECL_FUNC_INFO( && );
-		_DECL_FUNC_INFO( const && );
-		_DECL_FUNC_INFO( volatile && );
-		_DECL_FUNC_INFO( const volatile && );
-		_DECL_FUNC_INFO( && noexcept );
-		_DECL_FUNC_INFO( const && noexcept );
-		_DECL_FUNC_INFO( volatile && noexcept );
-		_DECL_FUNC_INFO( const volatile && noexcept );
+		_DECL_FUNC_INFO( const, true, false );
+		_DECL_FUNC_INFO( volatile, false, true );
+		_DECL_FUNC_INFO( const volatile, true, true );
+		_DECL_FUNC_INFO( noexcept, false, false );
+		_DECL_FUNC_INFO( const noexcept, true, false );
+		_DECL_FUNC_INFO( volatile noexcept, false, true );
+		_DECL_FUNC_INFO( const volatile noexcept, true, true );
+		_DECL_FUNC_INFO( &, false, false );
+		_DECL_FUNC_INFO( const &, true, false );
+		_DECL_FUNC_INFO( volatile &, false, true );
+		_DECL_FUNC_INFO( const volatile &, true, true );
+		_DECL_FUNC_INFO( & noexcept, false, false );
+		_DECL_FUNC_INFO( const & noexcept, true, false );
+		_DECL_FUNC_INFO( volatile & noexcept, false, true );
+		_DECL_FUNC_INFO( const volatile & noexcept, true, true );
+		_DECL_FUNC_INFO( &&, false, false );
+		_DECL_FUNC_INFO( const &&, true, false );
+		_DECL_FUNC_INFO( volatile &&, false, true );
+		_DECL_FUNC_INFO( const volatile &&, true, true );
+		_DECL_FUNC_INFO( && noexcept, false, false );
+		_DECL_FUNC_INFO( const && noexcept, true, false );
+		_DECL_FUNC_INFO( volatile && noexcept, false, true );
+		_DECL_FUNC_INFO( const volatile && noexcept, true, true );
 		#undef _DECL_FUNC_INFO
 
 		
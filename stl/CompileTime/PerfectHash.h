@@ -0,0 +1,184 @@
+// Copyright (c) 2019,  Zhirnov Andrey. For more information see 'LICENSE'
+/*
+	Perfect hash table for a set of strings, built at compile time.
+
+	The string hash is used to select a bucket, each bucket has its own seed
+	that places all strings of the bucket into free slots ('hash and displace').
+	Lookup is a single string hash, two table reads and a string comparison.
+*/
+
+#pragma once
+
+#include "stl/Common.h"
+#include "stl/CompileTime/UMax.h"
+
+namespace VSA
+{
+
+	//
+	// Static Perfect Hash
+	//
+
+	template <size_t N>
+	class StaticPerfectHash
+	{
+		STATIC_ASSERT( N > 0 and N < 0xFFFF );
+
+	// types
+	private:
+		static constexpr size_t		_SlotCount		= [] () { size_t n = 1;  while ( n < N*2 ) n <<= 1;  return n; }();
+		static constexpr size_t		_BucketCount	= _SlotCount / 4 > 0 ? _SlotCount / 4 : 1;
+		static constexpr uint		_MaxSeed		= 1u << 16;
+
+		using Keys_t	= StaticArray< StringView, N >;
+		using Seeds_t	= StaticArray< uint, _BucketCount >;
+		using Slots_t	= StaticArray< uint16_t, _SlotCount >;		// key index + 1, zero if empty
+
+
+	// variables
+	private:
+		Keys_t		_keys;
+		Seeds_t		_seeds	= {};
+		Slots_t		_slots	= {};
+		bool		_valid	= false;
+
+
+	// methods
+	public:
+		explicit constexpr StaticPerfectHash (const StringView (&keys)[N]) : _keys{}
+		{
+			uint	hashes [N]			= {};
+			uint	bucket_size [_BucketCount] = {};
+			bool	processed [_BucketCount] = {};
+
+			for (size_t i = 0; i < N; ++i)
+			{
+				_keys[i]	= keys[i];
+				hashes[i]	= _KeyHash( keys[i] );
+				++bucket_size[ _Bucket( hashes[i] )];
+
+				// duplicate keys or hash collision
+				for (size_t j = 0; j < i; ++j) {
+					if ( hashes[j] == hashes[i] )
+						return;
+				}
+			}
+
+			// place largest buckets first
+			for (size_t pass = 0; pass < _BucketCount; ++pass)
+			{
+				size_t	b = UMax;
+				for (size_t i = 0; i < _BucketCount; ++i) {
+					if ( not processed[i] and (b == UMax or bucket_size[i] > bucket_size[b]) )
+						b = i;
+				}
+				processed[b] = true;
+
+				if ( bucket_size[b] == 0 )
+					continue;
+
+				bool	placed = false;
+				for (uint seed = 0; seed < _MaxSeed and not placed; ++seed)
+				{
+					placed = true;
+					for (size_t i = 0; i < N and placed; ++i)
+					{
+						if ( _Bucket( hashes[i] ) != b )
+							continue;
+
+						auto&	slot = _slots[ _Slot( hashes[i], seed )];
+						if ( slot == 0 )
+							slot = uint16_t(i + 1);
+						else
+							placed = false;
+					}
+
+					if ( placed ) {
+						_seeds[b] = seed;
+						break;
+					}
+
+					// rollback
+					for (size_t i = 0; i < _SlotCount; ++i) {
+						if ( _slots[i] != 0 and _Bucket( hashes[_slots[i] - 1] ) == b )
+							_slots[i] = 0;
+					}
+				}
+
+				if ( not placed )
+					return;
+			}
+
+			_valid = true;
+		}
+
+		ND_ constexpr bool  IsValid () const	{ return _valid; }
+
+		ND_ static constexpr size_t  Count ()	{ return N; }
+
+		// returns index of the key in the source array or 'UMax'
+		ND_ constexpr size_t  Find (StringView key) const
+		{
+			const uint	h	= _KeyHash( key );
+			const uint	idx	= _slots[ _Slot( h, _seeds[ _Bucket( h )] )];
+
+			if ( idx != 0 and _keys[idx - 1] == key )
+				return idx - 1;
+
+			return UMax;
+		}
+
+	private:
+		// murmur3, reads 4 characters per step, byte-wise crc from 'CT_Hash' is too slow for runtime lookup
+		ND_ static constexpr uint  _KeyHash (StringView key)
+		{
+			const auto	Scramble = [] (uint k) -> uint
+			{
+				k *= 0xcc9e2d51u;
+				k  = (k << 15) | (k >> 17);
+				return k * 0x1b873593u;
+			};
+			const auto	Char = [key] (size_t i) -> uint { return uint(uint8_t( key[i] )); };
+
+			uint	h = 0;
+			size_t	i = 0;
+
+			for (; i + 4 <= key.size(); i += 4)
+			{
+				h ^= Scramble( Char(i) | (Char(i+1) << 8) | (Char(i+2) << 16) | (Char(i+3) << 24) );
+				h  = (h << 13) | (h >> 19);
+				h  = h * 5 + 0xe6546b64u;
+			}
+
+			uint	tail = 0;
+			for (uint shift = 0; i < key.size(); ++i, shift += 8) {
+				tail |= Char(i) << shift;
+			}
+			h ^= Scramble( tail );
+			h ^= uint(key.size());
+
+			return _Mix( h );
+		}
+
+		// murmur3 finalizer
+		ND_ static constexpr uint  _Mix (uint x)
+		{
+			x ^= x >> 16;	x *= 0x85ebca6bu;
+			x ^= x >> 13;	x *= 0xc2b2ae35u;
+			x ^= x >> 16;
+			return x;
+		}
+
+		ND_ static constexpr size_t  _Bucket (uint hash)
+		{
+			return hash & (_BucketCount - 1);
+		}
+
+		ND_ static constexpr size_t  _Slot (uint hash, uint seed)
+		{
+			return _Mix( hash ^ _Mix( seed + 0x9e3779b9u )) & (_SlotCount - 1);
+		}
+	};
+
+
+}	// VSA
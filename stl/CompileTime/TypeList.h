@@ -65,7 +65,7 @@ namespace _vsa_hidden_
 			if constexpr( I < Count )
 			{
 				using T = Get<I>;
-				fn.operator()<T,I>();
+				fn.template operator()<T,I>();
 				_Visit< I+1 >( std::forward<FN>(fn) );
 			}
 			VSA_UNUSED( fn );
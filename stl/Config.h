@@ -3,3 +3,9 @@
 #pragma once
 
 
+
+
+// use 'HashOf( ptr, size )' for arrays of POD types
+#ifndef VSA_FAST_HASH
+#	define VSA_FAST_HASH	0
+#endif
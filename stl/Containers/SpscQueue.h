@@ -0,0 +1,73 @@
+// Copyright (c) 2019,  Zhirnov Andrey. For more information see 'LICENSE'
+
+#pragma once
+
+#include "stl/Math/BitMath.h"
+#include <atomic>
+
+namespace VSA
+{
+
+	//
+	// Single Producer Single Consumer lock-free Queue
+	//
+
+	template <typename T, size_t Size>
+	struct SpscQueue
+	{
+		STATIC_ASSERT( IsPowerOfTwo( Size ));
+		STATIC_ASSERT( std::is_trivially_copyable_v<T> );
+
+	// variables
+	private:
+		static constexpr size_t		_Mask	= Size - 1;
+
+		T							_items [Size];
+		alignas(64) std::atomic<size_t>	_head	{0};	// next item to pop, modified by consumer
+		alignas(64) std::atomic<size_t>	_tail	{0};	// next item to push, modified by producer
+
+
+	// methods
+	public:
+		SpscQueue () : _items{} {}
+
+		SpscQueue (const SpscQueue &) = delete;
+		SpscQueue&  operator = (const SpscQueue &) = delete;
+
+		// producer only
+		ND_ bool  Push (const T &value)
+		{
+			const size_t	tail = _tail.load( std::memory_order_relaxed );
+
+			if ( tail - _head.load( std::memory_order_acquire ) >= Size )
+				return false;	// full
+
+			_items[ tail & _Mask ] = value;
+			_tail.store( tail + 1, std::memory_order_release );
+			return true;
+		}
+
+		// consumer only
+		ND_ bool  Pop (OUT T &value)
+		{
+			const size_t	head = _head.load( std::memory_order_relaxed );
+
+			if ( head == _tail.load( std::memory_order_acquire ))
+				return false;	// empty
+
+			value = _items[ head & _Mask ];
+			_head.store( head + 1, std::memory_order_release );
+			return true;
+		}
+
+		// approximate value if called concurrently
+		ND_ size_t  Count () const
+		{
+			return _tail.load( std::memory_order_acquire ) - _head.load( std::memory_order_acquire );
+		}
+
+		ND_ static constexpr size_t  Capacity ()	{ return Size; }
+	};
+
+
+}	// VSA
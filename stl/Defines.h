@@ -103,7 +103,7 @@
 
 # elif (defined(COMPILER_CLANG) or defined(COMPILER_GCC)) and defined(VSA_DEBUG)
 #  if 1
-#	include <exception>
+#	include <stdexcept>
 #	define VSA_PRIVATE_BREAK_POINT() 		throw std::runtime_error("breakpoint")
 #  else
 #	include <csignal>
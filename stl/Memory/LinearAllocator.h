@@ -38,6 +38,7 @@ namespace VSA
 	private:
 		Blocks_t					_blocks;
 		BytesU						_blockSize	= 1024_b;
+		BytesU						_maxUsed;		// high-water mark before last discard
 		Allocator_t					_alloc;
 		static constexpr BytesU		_ptrAlign	= SizeOf<void *>;
 
@@ -54,6 +55,7 @@ namespace VSA
 		LinearAllocator (LinearAllocator &&other) :
 			_blocks{ std::move(other._blocks) },
 			_blockSize{ other._blockSize },
+			_maxUsed{ other._maxUsed },
 			_alloc{ std::move(other._alloc) }
 		{}
 
@@ -67,6 +69,7 @@ namespace VSA
 			Release();
 			_blocks		= std::move(rhs._blocks);
 			_blockSize	= rhs._blockSize;
+			_maxUsed	= rhs._maxUsed;
 			_alloc		= std::move(rhs._alloc);
 			return *this;
 		}
@@ -116,6 +119,8 @@ namespace VSA
 
 		void Discard ()
 		{
+			_maxUsed = HighWaterMark();
+
 			for (auto& block : _blocks) {
 				block.size = 0_b;
 			}
@@ -128,6 +133,35 @@ namespace VSA
 			}
 			_blocks.clear();
 		}
+
+
+		ND_ BytesU  UsedSize () const
+		{
+			BytesU	size;
+			for (auto& block : _blocks) {
+				size += block.size;
+			}
+			return size;
+		}
+
+		ND_ BytesU  Capacity () const
+		{
+			BytesU	size;
+			for (auto& block : _blocks) {
+				size += block.capacity;
+			}
+			return size;
+		}
+
+		ND_ BytesU  HighWaterMark () const
+		{
+			return Max( _maxUsed, UsedSize() );
+		}
+
+		ND_ BytesU  BlockSize () const
+		{
+			return _blockSize;
+		}
 	};
 
 
@@ -244,6 +278,11 @@ namespace VSA
 		{
 			return &_alloc == &rhs._alloc;
 		}
+
+		ND_ bool operator != (const Self &rhs) const
+		{
+			return not (*this == rhs);
+		}
 	};
 
 
@@ -0,0 +1,102 @@
+// Copyright (c) 2019,  Zhirnov Andrey. For more information see 'LICENSE'
+
+#include "stl/Platforms/PerformanceCounter.h"
+#include "stl/Platforms/WindowsHeader.h"
+#include <chrono>
+
+#ifndef PLATFORM_WINDOWS
+#	include <time.h>
+#endif
+
+#ifdef VSA_PERF_COUNTER_USE_TSC
+# ifdef COMPILER_MSVC
+#	include <intrin.h>
+# else
+#	include <x86intrin.h>
+# endif
+#endif
+
+namespace VSA
+{
+namespace
+{
+/*
+=================================================
+	OSNanoseconds
+=================================================
+*/
+	ND_ static uint64_t  OSNanoseconds ()
+	{
+	#if defined(PLATFORM_WINDOWS)
+		static const uint64_t	freq = [] () {
+				LARGE_INTEGER	f;
+				::QueryPerformanceFrequency( OUT &f );
+				return uint64_t(f.QuadPart);
+			}();
+
+		LARGE_INTEGER	counter;
+		::QueryPerformanceCounter( OUT &counter );
+
+		// split to avoid overflow
+		const uint64_t	ticks = uint64_t(counter.QuadPart);
+		return (ticks / freq) * 1'000'000'000ull + ((ticks % freq) * 1'000'000'000ull) / freq;
+
+	#elif defined(CLOCK_MONOTONIC_RAW)
+		timespec	ts;
+		::clock_gettime( CLOCK_MONOTONIC_RAW, OUT &ts );
+		return uint64_t(ts.tv_sec) * 1'000'000'000ull + uint64_t(ts.tv_nsec);
+
+	#else
+		return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count());
+	#endif
+	}
+
+#ifdef VSA_PERF_COUNTER_USE_TSC
+/*
+=================================================
+	TscCalibration
+----
+	measures TSC frequency against OS timer once,
+	takes about 10ms at first call.
+=================================================
+*/
+	struct TscCalibration
+	{
+		uint64_t	tsc0		= 0;
+		uint64_t	ns0			= 0;
+		double		nsPerTick	= 0.0;
+
+		TscCalibration ()
+		{
+			ns0		= OSNanoseconds();
+			tsc0	= __rdtsc();
+
+			uint64_t	ns1;
+			do {
+				ns1 = OSNanoseconds();
+			} while ( ns1 - ns0 < 10'000'000 );
+
+			nsPerTick = double(ns1 - ns0) / double(__rdtsc() - tsc0);
+		}
+	};
+#endif
+
+}	// namespace
+
+/*
+=================================================
+	Now
+=================================================
+*/
+	uint64_t  PerformanceCounter::Now ()
+	{
+	#ifdef VSA_PERF_COUNTER_USE_TSC
+		static const TscCalibration		calib;
+		return calib.ns0 + uint64_t(double(__rdtsc() - calib.tsc0) * calib.nsPerTick);
+	#else
+		return OSNanoseconds();
+	#endif
+	}
+
+
+}	// VSA
@@ -0,0 +1,23 @@
+// Copyright (c) 2019,  Zhirnov Andrey. For more information see 'LICENSE'
+
+#pragma once
+
+#include "stl/Common.h"
+
+namespace VSA
+{
+
+	//
+	// Performance Counter
+	//
+
+	struct PerformanceCounter
+	{
+		// monotonic time in nanoseconds, origin is unspecified.
+		// uses QueryPerformanceCounter on Windows and CLOCK_MONOTONIC_RAW on Linux,
+		// define 'VSA_PERF_COUNTER_USE_TSC' to read TSC directly (requires invariant TSC).
+		ND_ static uint64_t  Now ();
+	};
+
+
+}	// VSA
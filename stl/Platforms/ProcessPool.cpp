@@ -0,0 +1,252 @@
+// Copyright (c) 2019,  Zhirnov Andrey. For more information see 'LICENSE'
+
+#include "stl/Platforms/ProcessPool.h"
+#include "stl/Platforms/WindowsHeader.h"
+#include "stl/Algorithms/StringUtils.h"
+
+#ifdef PLATFORM_WINDOWS
+# ifdef COMPILER_MSVC
+#	pragma warning (push)
+#	pragma warning (disable: 4668)
+#	include <processthreadsapi.h>
+#	pragma warning (pop)
+# else
+#	include <processthreadsapi.h>
+# endif
+#else
+#	include <spawn.h>
+#	include <signal.h>
+#	include <fcntl.h>
+#	include <unistd.h>
+#	include <sys/wait.h>
+#	include <cerrno>
+#	include <cstring>
+
+extern char **environ;
+#endif
+
+namespace VSA
+{
+
+/*
+=================================================
+	constructor
+=================================================
+*/
+	ProcessPool::ProcessPool (uint maxProcesses) :
+		_maxProcesses{ Max( maxProcesses, 1u )}
+	{}
+
+/*
+=================================================
+	destructor
+----
+	waits until all queued processes are finished
+=================================================
+*/
+	ProcessPool::~ProcessPool ()
+	{
+		{
+			EXLOCK( _guard );
+			_looping = false;
+		}
+		_wakeCV.notify_all();
+
+		for (auto& worker : _workers) {
+			worker.join();
+		}
+	}
+
+/*
+=================================================
+	Run
+=================================================
+*/
+	void  ProcessPool::Run (Args_t &&args, Timeout_t timeout, Callback_t &&callback)
+	{
+		CHECK_ERR( args.size(), void());
+		{
+			EXLOCK( _guard );
+			_queue.push_back( Task{ std::move(args), timeout, std::move(callback) });
+
+			if ( _idleWorkers == 0 and _workers.size() < _maxProcesses )
+				_workers.emplace_back( [this] () { _WorkerLoop(); });
+		}
+		_wakeCV.notify_one();
+	}
+
+/*
+=================================================
+	_WorkerLoop
+=================================================
+*/
+	void  ProcessPool::_WorkerLoop ()
+	{
+		for (;;)
+		{
+			Task	task;
+			{
+				std::unique_lock	lock{ _guard };
+
+				++_idleWorkers;
+				_wakeCV.wait( lock, [this] () { return _queue.size() or not _looping; });
+				--_idleWorkers;
+
+				if ( _queue.empty() )
+					return;
+
+				task = std::move( _queue.front() );
+				_queue.pop_front();
+			}
+
+			const Result	res = Execute( task.args, task.timeout );
+
+			if ( task.callback )
+				task.callback( task.args, res );
+		}
+	}
+
+/*
+=================================================
+	Execute
+=================================================
+*/
+#ifdef PLATFORM_WINDOWS
+	ProcessPool::Result  ProcessPool::Execute (const Args_t &args, Timeout_t timeout)
+	{
+		Result	res;
+		CHECK_ERR( args.size(), res );
+
+		String	command_line;
+		for (auto& arg : args)
+		{
+			if ( command_line.size() )
+				command_line << ' ';
+
+			command_line << '"';
+			for (char c : arg)
+			{
+				if ( c == '"' )
+					command_line << '\\';
+				command_line << c;
+			}
+			command_line << '"';
+		}
+
+		STARTUPINFOA			startup_info = {};
+		PROCESS_INFORMATION		proc_info	 = {};
+		startup_info.cb = sizeof(startup_info);
+
+		bool process_created = ::CreateProcessA(
+			NULL,
+			command_line.data(),
+			NULL,
+			NULL,
+			FALSE,
+			CREATE_NO_WINDOW,
+			NULL,
+			NULL,
+			OUT &startup_info,
+			OUT &proc_info
+		);
+
+		if ( not process_created )
+		{
+			res.error = "CreateProcess failed with error "s << ToString( uint(::GetLastError()) );
+			return res;
+		}
+
+		if ( ::WaitForSingleObject( proc_info.hProcess, DWORD(timeout.count()) ) == WAIT_OBJECT_0 )
+		{
+			DWORD	process_exit = 0;
+			::GetExitCodeProcess( proc_info.hProcess, OUT &process_exit );
+
+			res.status		= EStatus::Completed;
+			res.exitCode	= int(process_exit);
+		}
+		else
+		{
+			::TerminateProcess( proc_info.hProcess, 1 );
+			::WaitForSingleObject( proc_info.hProcess, INFINITE );
+			res.status	= EStatus::Timeout;
+			res.error	= "process was terminated by timeout";
+		}
+
+		::CloseHandle( proc_info.hThread );
+		::CloseHandle( proc_info.hProcess );
+		return res;
+	}
+
+#else
+	ProcessPool::Result  ProcessPool::Execute (const Args_t &args, Timeout_t timeout)
+	{
+		using Clock_t = std::chrono::steady_clock;
+
+		Result	res;
+		CHECK_ERR( args.size(), res );
+
+		Array<char *>	argv;
+		for (auto& arg : args) {
+			argv.push_back( const_cast<char *>( arg.c_str() ));
+		}
+		argv.push_back( null );
+
+		// don't share input with the application
+		posix_spawn_file_actions_t	actions;
+		::posix_spawn_file_actions_init( OUT &actions );
+		::posix_spawn_file_actions_addopen( INOUT &actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0 );
+
+		pid_t	pid = 0;
+		int		err = ::posix_spawnp( OUT &pid, argv[0], &actions, null, argv.data(), environ );
+
+		::posix_spawn_file_actions_destroy( INOUT &actions );
+
+		if ( err != 0 )
+		{
+			res.error = "posix_spawn failed: "s << std::strerror( err );
+			return res;
+		}
+
+		const auto	deadline = Clock_t::now() + timeout;
+
+		for (;;)
+		{
+			int		status	= 0;
+			pid_t	r		= ::waitpid( pid, OUT &status, WNOHANG );
+
+			if ( r == pid )
+			{
+				res.status = EStatus::Completed;
+
+				if ( WIFEXITED( status ))
+					res.exitCode = WEXITSTATUS( status );
+				else
+				if ( WIFSIGNALED( status ))
+					res.error = "process was killed by signal "s << ToString( WTERMSIG( status ));
+
+				return res;
+			}
+
+			if ( r < 0 and errno != EINTR )
+			{
+				res.error = "waitpid failed: "s << std::strerror( errno );
+				return res;
+			}
+
+			if ( Clock_t::now() > deadline )
+			{
+				::kill( pid, SIGKILL );
+				::waitpid( pid, OUT &status, 0 );
+
+				res.status	= EStatus::Timeout;
+				res.error	= "process was killed by timeout";
+				return res;
+			}
+
+			std::this_thread::sleep_for( std::chrono::milliseconds(5) );
+		}
+	}
+#endif
+
+
+}	// VSA
@@ -0,0 +1,89 @@
+// Copyright (c) 2019,  Zhirnov Andrey. For more information see 'LICENSE'
+
+#pragma once
+
+#include "stl/Common.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <chrono>
+
+namespace VSA
+{
+
+	//
+	// Process Pool
+	//
+	// Processes are started asynchronously, at most 'maxProcesses' are running at the same time,
+	// others are waiting in the queue. Arguments are passed without shell, so quotes and spaces are not interpreted.
+	// Uses 'CreateProcess' on Windows and 'posix_spawn' on other platforms.
+	//
+
+	class ProcessPool
+	{
+	// types
+	public:
+		enum class EStatus : uint
+		{
+			Completed,		// process exited, see 'exitCode'
+			Failed,			// process was not started, see 'error'
+			Timeout,		// process was killed
+		};
+
+		struct Result
+		{
+			EStatus		status		= EStatus::Failed;
+			int			exitCode	= -1;
+			String		error;
+
+			ND_ bool  IsSucceeded () const	{ return status == EStatus::Completed and exitCode == 0; }
+		};
+
+		using Args_t		= Array< String >;		// executable and arguments
+		using Callback_t	= Function< void (const Args_t &, const Result &) >;
+		using Timeout_t		= std::chrono::milliseconds;
+
+	private:
+		struct Task
+		{
+			Args_t			args;
+			Timeout_t		timeout;
+			Callback_t		callback;
+		};
+
+		using TaskQueue_t	= std::deque< Task >;
+
+
+	// variables
+	private:
+		std::mutex					_guard;			// protects all
+		std::condition_variable		_wakeCV;
+		TaskQueue_t					_queue;
+		Array< std::thread >		_workers;		// started on demand
+		uint						_idleWorkers	= 0;
+		bool						_looping		= true;
+		const uint					_maxProcesses;
+
+
+	// methods
+	public:
+		explicit ProcessPool (uint maxProcesses);
+		~ProcessPool ();
+
+		ProcessPool (const ProcessPool &) = delete;
+		ProcessPool&  operator = (const ProcessPool &) = delete;
+
+		// thread safe, 'callback' is called from the worker thread when the process is finished
+		void  Run (Args_t &&args, Timeout_t timeout, Callback_t &&callback);
+
+		// runs process on the current thread
+		ND_ static Result  Execute (const Args_t &args, Timeout_t timeout);
+
+	private:
+		void  _WorkerLoop ();
+	};
+
+
+}	// VSA
@@ -0,0 +1,164 @@
+// Copyright (c) 2019,  Zhirnov Andrey. For more information see 'LICENSE'
+/*
+	Offline converter from the binary trace (see 'VSA_TRACE_FILE') to the graph.
+
+	usage: VSA-TraceToGraph <trace> <output.dot> [first frame] [frame count]
+
+	Frames are numbered from the start of the trace, frames dropped by the writer
+	keep their numbers, so the range may contain less frames than requested.
+
+	Dot-file is converted to the 'png' if graphviz is found.
+*/
+
+#include "src/SyncTrace.h"
+#include "src/SyncGraph.h"
+#include "stl/Algorithms/StringUtils.h"
+#include "stl/Stream/FileStream.h"
+#include "stl/Platforms/ProcessPool.h"
+
+#include <iostream>
+
+using namespace VSA;
+
+namespace
+{
+/*
+=================================================
+	ParseUInt
+=================================================
+*/
+	ND_ static bool  ParseUInt (StringView str, OUT uint &result)
+	{
+		result = 0;
+		for (char c : str)
+		{
+			if ( c < '0' or c > '9' )
+				return false;
+
+			result = result * 10 + uint(c - '0');
+		}
+		return not str.empty();
+	}
+	
+/*
+=================================================
+	SelectFrames
+----
+	removes events outside of the frame range,
+	handle ranges in remaining events are still valid.
+=================================================
+*/
+	static void  SelectFrames (INOUT SyncEventBuffer &capture, ArrayView<SyncTrace::Frame> frames, uint first, uint count)
+	{
+		const uint64_t	last		= uint64_t(first) + count;
+		size_t			first_event	= capture.events.size();
+		size_t			last_event	= capture.events.size();
+
+		for (auto& frame : frames)
+		{
+			if ( frame.id >= first and first_event == capture.events.size() )
+				first_event = frame.firstEvent;
+
+			if ( frame.id >= last )
+			{
+				last_event = frame.firstEvent;
+				break;
+			}
+		}
+		first_event = Min( first_event, last_event );
+
+		capture.events.erase( capture.events.begin() + last_event, capture.events.end() );
+		capture.events.erase( capture.events.begin(), capture.events.begin() + first_event );
+	}
+	
+/*
+=================================================
+	Visualize
+=================================================
+*/
+#ifdef VSA_GRAPHVIZ_DOT_EXECUTABLE
+	ND_ static ProcessPool::Result  Visualize (StringView path, StringView format)
+	{
+		// big traces may take a long time to render
+		const auto	timeout = std::chrono::minutes{10};
+
+		return ProcessPool::Execute( { VSA_GRAPHVIZ_DOT_EXECUTABLE, "-T"s << format, "-O", String{path} }, timeout );
+	}
+#endif
+
+}	// namespace
+
+/*
+=================================================
+	main
+=================================================
+*/
+int main (int argc, char** argv)
+{
+	if ( argc < 3 )
+	{
+		std::cerr << "usage: VSA-TraceToGraph <trace> <output.dot> [first frame] [frame count]" << std::endl;
+		return 1;
+	}
+
+	const StringView	trace_path	= argv[1];
+	const StringView	dot_path	= argv[2];
+	uint				first		= 0;
+	uint				count		= UMax;
+
+	if ( (argc > 3 and not ParseUInt( argv[3], OUT first )) or
+		 (argc > 4 and not ParseUInt( argv[4], OUT count )) )
+	{
+		std::cerr << "invalid frame range" << std::endl;
+		return 1;
+	}
+
+	CaptureArena_t				arena;
+	SyncEventBuffer				capture		{arena};
+	Array<SyncTrace::Frame>		frames;
+	{
+		FileRStream		file{ trace_path };
+		if ( not file.IsOpen() )
+		{
+			std::cerr << "can't open trace file '" << trace_path << "'" << std::endl;
+			return 1;
+		}
+
+		if ( not SyncTrace::ReadAll( file, INOUT frames, INOUT capture ))
+		{
+			std::cerr << "failed to read trace file '" << trace_path << "'" << std::endl;
+			return 1;
+		}
+	}
+
+	std::cout << "loaded " << frames.size() << " frames, " << capture.events.size() << " events" << std::endl;
+
+	if ( frames.size() and frames.back().id + 1 > frames.size() )
+		std::cout << (frames.back().id + 1 - frames.size()) << " frames were dropped by the writer" << std::endl;
+
+	SelectFrames( INOUT capture, frames, first, count );
+	SyncGraph::SortEvents( INOUT capture );
+	SyncGraph::ResolveDependencies( INOUT capture, arena );
+
+	{
+		FileWStream		file{ dot_path };
+		if ( not SyncGraph::WriteDot_v1( capture, file ))
+		{
+			std::cerr << "can't write dot file '" << dot_path << "'" << std::endl;
+			return 1;
+		}
+		std::cout << "dot-file saved into '" << dot_path << "'" << std::endl;
+	}
+
+#ifdef VSA_GRAPHVIZ_DOT_EXECUTABLE
+	if ( auto res = Visualize( dot_path, "png" ); not res.IsSucceeded() )
+	{
+		std::cerr << "failed to run graphviz: "
+				  << (res.error.size() ? res.error : "exit code "s << ToString( res.exitCode )) << std::endl;
+		return 1;
+	}
+	std::cout << "graph saved into '" << dot_path << ".png'" << std::endl;
+#endif
+
+	return 0;
+}